@@ -0,0 +1,427 @@
+#include "batch.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "fen.h"
+#include "movegen.h"
+
+namespace {
+
+// Lines read ahead of the oldest unfinished one, per worker
+constexpr size_t ReadAheadPerWorker = 16;
+
+struct Job {
+    size_t index;
+    size_t lineNumber;
+    std::string line;
+};
+
+// Each worker takes jobs from the front of its own queue and, once that is empty, steals
+// from the back of the others, so a run of slow positions on one worker does not hold up the rest.
+class JobPool {
+public:
+    explicit JobPool(int workers) : queues(workers) {}
+
+    void push(Job job) {
+        Queue& queue = queues[job.index % queues.size()];
+        {
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.jobs.push_back(std::move(job));
+        }
+        std::lock_guard<std::mutex> lock(signalMutex);
+        queued++;
+        signal.notify_one();
+    }
+
+    // Blocks until there is a job; false once the pool is closed and empty
+    bool pop(int worker, Job& job) {
+        while (true) {
+            if (take(worker, job)) {
+                std::lock_guard<std::mutex> lock(signalMutex);
+                queued--;
+                return true;
+            }
+            std::unique_lock<std::mutex> lock(signalMutex);
+            if (queued == 0 && closed) return false;
+            signal.wait(lock, [this] { return queued > 0 || closed; });
+        }
+    }
+
+    void close() {
+        std::lock_guard<std::mutex> lock(signalMutex);
+        closed = true;
+        signal.notify_all();
+    }
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Job> jobs;
+    };
+
+    std::vector<Queue> queues;
+    std::mutex signalMutex;
+    std::condition_variable signal;
+    size_t queued = 0;
+    bool closed = false;
+
+    bool take(int worker, Job& job) {
+        int count = static_cast<int>(queues.size());
+        for (int i = 0; i < count; ++i) {
+            Queue& queue = queues[(worker + i) % count];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (queue.jobs.empty()) continue;
+            if (i == 0) {
+                job = std::move(queue.jobs.front());
+                queue.jobs.pop_front();
+            } else {
+                job = std::move(queue.jobs.back());
+                queue.jobs.pop_back();
+            }
+            return true;
+        }
+        return false;
+    }
+};
+
+// Holds finished results until everything before them is written
+class OrderedWriter {
+public:
+    explicit OrderedWriter(std::ostream& output) : output(output) {}
+
+    void write(size_t index, std::string line) {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending.emplace(index, std::move(line));
+        while (!pending.empty() && pending.begin()->first == next) {
+            output << pending.begin()->second << '\n';
+            pending.erase(pending.begin());
+            next++;
+        }
+        output.flush();
+        advanced.notify_all();
+    }
+
+    // Keeps the reader from getting more than window lines ahead of the output
+    void waitForRoom(size_t index, size_t window) {
+        std::unique_lock<std::mutex> lock(mutex);
+        advanced.wait(lock, [&] { return index < next + window; });
+    }
+
+private:
+    std::ostream& output;
+    std::mutex mutex;
+    std::condition_variable advanced;
+    std::map<size_t, std::string> pending;
+    size_t next = 0;
+};
+
+struct EpdRecord {
+    std::string_view fen;
+    std::string id;
+    // Expected and avoided moves, usually in SAN
+    std::vector<std::string> bestMoves;
+    std::vector<std::string> avoidMoves;
+};
+
+bool isNumber(std::string_view text) {
+    if (text.empty()) return false;
+    for (char c : text) {
+        if (c < '0' || c > '9') return false;
+    }
+    return true;
+}
+
+// Splits a line into the FEN (four fields, or six with the counters) and its EPD operations,
+// e.g. `bm Qg6; id "WAC.001";`
+EpdRecord parseEpd(std::string_view line) {
+    EpdRecord record;
+    size_t pos = 0;
+    auto nextField = [&](size_t& start) {
+        while (pos < line.size() && line[pos] == ' ') ++pos;
+        start = pos;
+        while (pos < line.size() && line[pos] != ' ') ++pos;
+        return line.substr(start, pos - start);
+    };
+
+    size_t start = 0;
+    for (int field = 0; field < 4; ++field) nextField(start);
+    size_t fenEnd = pos;
+    size_t afterFour = pos;
+    if (isNumber(nextField(start)) && isNumber(nextField(start))) {
+        fenEnd = pos;
+    } else {
+        pos = afterFour;
+    }
+    record.fen = line.substr(0, fenEnd);
+
+    // Operations: an opcode followed by operands up to a semicolon; strings are quoted
+    while (pos < line.size()) {
+        std::string_view opcode = nextField(start);
+        if (opcode.empty()) break;
+        std::vector<std::string> operands;
+        bool ended = !opcode.empty() && opcode.back() == ';';
+        if (ended) opcode.remove_suffix(1);
+        while (!ended && pos < line.size()) {
+            while (pos < line.size() && line[pos] == ' ') ++pos;
+            if (pos == line.size()) break;
+            std::string operand;
+            if (line[pos] == '"') {
+                size_t close = line.find('"', pos + 1);
+                if (close == std::string_view::npos) close = line.size();
+                operand = std::string(line.substr(pos + 1, close - pos - 1));
+                pos = std::min(close + 1, line.size());
+            } else {
+                while (pos < line.size() && line[pos] != ' ' && line[pos] != ';') operand += line[pos++];
+            }
+            if (pos < line.size() && line[pos] == ';') {
+                ended = true;
+                ++pos;
+            }
+            if (!operand.empty()) operands.push_back(operand);
+        }
+
+        if (opcode == "id" && !operands.empty()) {
+            record.id = operands[0];
+        } else if (opcode == "bm") {
+            record.bestMoves = operands;
+        } else if (opcode == "am") {
+            record.avoidMoves = operands;
+        }
+    }
+    return record;
+}
+
+// Standard algebraic notation without the check and mate suffixes
+std::string toSan(const Position& position, Move move, const MoveList& legalMoves) {
+    int from = move.from();
+    int to = move.to();
+    if (move.kind() == MoveKind::Castling) return fileOf(to) == 6 ? "O-O" : "O-O-O";
+
+    static const char Letters[6] = { 'K', 'Q', 'B', 'N', 'R', 'P' };
+    PieceType type = position.typeOn(from);
+    bool capture = !position.isEmpty(to) || move.kind() == MoveKind::EnPassant;
+    std::string san;
+
+    if (type == PieceType::Pawn) {
+        if (capture) san += static_cast<char>('a' + fileOf(from));
+    } else {
+        san += Letters[static_cast<int>(type)];
+        // Name the file, else the rank, else both, if another piece of the kind can go there too
+        bool ambiguous = false, sameFile = false, sameRank = false;
+        for (Move other : legalMoves) {
+            if (other.to() != to || other.from() == from || position.typeOn(other.from()) != type) continue;
+            ambiguous = true;
+            sameFile |= fileOf(other.from()) == fileOf(from);
+            sameRank |= rankOf(other.from()) == rankOf(from);
+        }
+        if (ambiguous) {
+            if (!sameFile) {
+                san += static_cast<char>('a' + fileOf(from));
+            } else if (!sameRank) {
+                san += static_cast<char>('1' + rankOf(from));
+            } else {
+                san += static_cast<char>('a' + fileOf(from));
+                san += static_cast<char>('1' + rankOf(from));
+            }
+        }
+    }
+
+    if (capture) san += 'x';
+    san += static_cast<char>('a' + fileOf(to));
+    san += static_cast<char>('1' + rankOf(to));
+    if (move.kind() == MoveKind::Promotion) {
+        san += '=';
+        san += Letters[static_cast<int>(move.promotion())];
+    }
+    return san;
+}
+
+// Drops annotations and check marks, and accepts castling written with zeros
+std::string normaliseSan(std::string san) {
+    while (!san.empty() && (san.back() == '+' || san.back() == '#' || san.back() == '!' || san.back() == '?')) {
+        san.pop_back();
+    }
+    if (san == "0-0") return "O-O";
+    if (san == "0-0-0") return "O-O-O";
+    return san;
+}
+
+bool matchesAny(const std::vector<std::string>& moves, const std::string& san, const std::string& uci) {
+    for (const std::string& move : moves) {
+        std::string normalised = normaliseSan(move);
+        if (normalised == san || normalised == uci) return true;
+    }
+    return false;
+}
+
+void writeJsonString(std::ostream& out, std::string_view text) {
+    static const char Hex[] = "0123456789abcdef";
+    out << '"';
+    for (char c : text) {
+        switch (c) {
+            case '"': out << "\\\""; break;
+            case '\\': out << "\\\\"; break;
+            case '\t': out << "\\t"; break;
+            case '\r': out << "\\r"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    out << "\\u00" << Hex[(c >> 4) & 0xF] << Hex[c & 0xF];
+                } else {
+                    out << c;
+                }
+                break;
+        }
+    }
+    out << '"';
+}
+
+void writeJsonList(std::ostream& out, const std::vector<std::string>& items) {
+    out << '[';
+    for (size_t i = 0; i < items.size(); ++i) {
+        if (i) out << ',';
+        writeJsonString(out, items[i]);
+    }
+    out << ']';
+}
+
+struct Worker {
+    Engine engine;
+    SearchInfo lastInfo;
+    bool hasInfo = false;
+};
+
+std::string analyse(Worker& worker, const Job& job, const SearchLimits& limits, bool& failed) {
+    std::ostringstream out;
+    out << "{\"line\":" << job.lineNumber;
+
+    EpdRecord record = parseEpd(job.line);
+    if (!record.id.empty()) {
+        out << ",\"id\":";
+        writeJsonString(out, record.id);
+    }
+    out << ",\"fen\":";
+    writeJsonString(out, record.fen);
+
+    FenError error;
+    if (!worker.engine.setBoardState(record.fen, &error)) {
+        failed = true;
+        out << ",\"error\":";
+        writeJsonString(out, std::string("invalid fen: ") + error.message);
+        out << '}';
+        return out.str();
+    }
+
+    worker.engine.clearHash();
+    worker.hasInfo = false;
+    Move best = worker.engine.search(limits);
+
+    // The position is not changed by searching, so moves can still be described in it
+    Position position;
+    parseFen(record.fen, position);
+    MoveList legalMoves;
+    generateLegalMoves(position, legalMoves);
+
+    if (best.isNone()) {
+        out << ",\"bestmove\":null,\"result\":\"" << (position.inCheck() ? "checkmate" : "stalemate") << '"';
+    } else {
+        out << ",\"bestmove\":\"" << best.toString() << "\",\"san\":";
+        writeJsonString(out, toSan(position, best, legalMoves));
+    }
+    if (worker.hasInfo) {
+        const SearchInfo& info = worker.lastInfo;
+        if (std::abs(info.score) >= MateBound) {
+            out << ",\"score\":{\"mate\":" << mateInMoves(info.score) << '}';
+        } else {
+            out << ",\"score\":{\"cp\":" << info.score << '}';
+        }
+        out << ",\"depth\":" << info.depth;
+    }
+    out << ",\"nodes\":" << worker.engine.getNodes();
+    if (worker.hasInfo) {
+        out << ",\"time\":" << worker.lastInfo.time << ",\"pv\":[";
+        for (size_t i = 0; i < worker.lastInfo.pv.size(); ++i) {
+            out << (i ? ",\"" : "\"") << worker.lastInfo.pv[i].toString() << '"';
+        }
+        out << ']';
+    }
+    if (StatsEnabled) out << ",\"stats\":" << statsToJson(worker.engine.getStats());
+
+    if (!record.bestMoves.empty() || !record.avoidMoves.empty()) {
+        std::string san = best.isNone() ? "" : toSan(position, best, legalMoves);
+        std::string uci = best.toString();
+        bool solved = !best.isNone();
+        if (!record.bestMoves.empty()) {
+            out << ",\"bm\":";
+            writeJsonList(out, record.bestMoves);
+            solved = solved && matchesAny(record.bestMoves, san, uci);
+        }
+        if (!record.avoidMoves.empty()) {
+            out << ",\"am\":";
+            writeJsonList(out, record.avoidMoves);
+            solved = solved && !matchesAny(record.avoidMoves, san, uci);
+        }
+        out << ",\"solved\":" << (solved ? "true" : "false");
+    }
+    out << '}';
+    return out.str();
+}
+
+} // namespace
+
+size_t runBatch(const BatchOptions& options, std::istream& input, std::ostream& output) {
+    int workerCount = std::max(1, options.workers);
+    std::vector<std::unique_ptr<Worker>> workers;
+    for (int i = 0; i < workerCount; ++i) {
+        workers.push_back(std::make_unique<Worker>());
+        Worker& worker = *workers.back();
+        worker.engine.setHashSize(options.hashMegabytes);
+        // The search calls back on the worker's own thread
+        worker.engine.setInfoCallback([&worker](const SearchInfo& info) {
+            worker.lastInfo = info;
+            worker.hasInfo = true;
+        });
+    }
+
+    JobPool pool(workerCount);
+    OrderedWriter writer(output);
+    std::atomic<size_t> failures(0);
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < workerCount; ++i) {
+        threads.emplace_back([&, i] {
+            Job job;
+            while (pool.pop(i, job)) {
+                bool failed = false;
+                std::string result = analyse(*workers[i], job, options.limits, failed);
+                if (failed) failures++;
+                writer.write(job.index, std::move(result));
+            }
+        });
+    }
+
+    std::string line;
+    size_t lineNumber = 0;
+    size_t index = 0;
+    while (std::getline(input, line)) {
+        lineNumber++;
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        size_t first = line.find_first_not_of(" \t");
+        if (first == std::string::npos || line[first] == '#') continue;
+
+        writer.waitForRoom(index, ReadAheadPerWorker * workerCount);
+        pool.push({ index++, lineNumber, line.substr(first) });
+    }
+    pool.close();
+    for (std::thread& thread : threads) thread.join();
+    return failures;
+}
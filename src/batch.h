@@ -0,0 +1,25 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <cstddef>
+#include <istream>
+#include <ostream>
+#include "engine.h"
+
+struct BatchOptions {
+    // Budget for every position; at least one of depth, nodes and movetime should be set
+    SearchLimits limits;
+    // Independent single-threaded engines searching in parallel
+    int workers = 1;
+    // Hash table of each engine, cleared before every position so results do not
+    // depend on which worker searched what before
+    size_t hashMegabytes = 16;
+};
+
+// Analyses every FEN or EPD line of input and writes one JSON object per line to output,
+// in input order. Blank lines and lines starting with '#' are skipped. Lines are read
+// as the workers need them, so the input can be far larger than memory.
+// Returns the number of lines that could not be parsed.
+size_t runBatch(const BatchOptions& options, std::istream& input, std::ostream& output);
+
+#endif // BATCH_H
@@ -0,0 +1,21 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <cstdint>
+#include <ostream>
+
+constexpr int DefaultBenchDepth = 8;
+
+struct BenchResult {
+    // Summed over every position; the signature of the search
+    uint64_t nodes = 0;
+    int64_t milliseconds = 0;
+    uint64_t nps = 0;
+};
+
+// Searches a fixed set of about fifty positions to depth on one thread with a fresh 16 MB hash
+// table each, writing a line per position to out. The node count depends only on the search, not
+// on the machine or the compiler, so a patch meant to leave the search alone must not change it.
+BenchResult runBench(int depth, std::ostream& out);
+
+#endif // BENCH_H
@@ -0,0 +1,20 @@
+// Headless search benchmark: searches a fixed set of positions to a fixed depth on one
+// thread and prints the total node count and speed. Same as chess_engine_uci bench.
+//
+//   bench [depth]
+
+#include <cstdlib>
+#include <iostream>
+#include "bench.h"
+
+int main(int argc, char* argv[]) {
+    int depth = argc > 1 ? std::atoi(argv[1]) : DefaultBenchDepth;
+    if (depth < 1) {
+        std::cerr << "usage: bench [depth]" << std::endl;
+        return 2;
+    }
+
+    BenchResult result = runBench(depth, std::cout);
+    std::cout << "nodes " << result.nodes << " time " << result.milliseconds << "ms nps " << result.nps << std::endl;
+    return 0;
+}
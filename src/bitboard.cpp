@@ -0,0 +1,169 @@
+#include "bitboard.h"
+
+Magic rookMagics[64];
+Magic bishopMagics[64];
+Bitboard knightAttackTable[64];
+Bitboard kingAttackTable[64];
+Bitboard pawnAttackTable[2][64];
+Bitboard betweenTable[64][64];
+Bitboard lineTable[64][64];
+
+namespace {
+
+// Every blocker subset of every square shares these two tables
+Bitboard rookTable[0x19000];
+Bitboard bishopTable[0x1480];
+
+const int rookDirections[4][2] = { {0, 1}, {0, -1}, {1, 0}, {-1, 0} };
+const int bishopDirections[4][2] = { {1, 1}, {1, -1}, {-1, 1}, {-1, -1} };
+
+bool onBoard(int file, int rank) {
+    return file >= 0 && file < 8 && rank >= 0 && rank < 8;
+}
+
+Bitboard leaperAttacks(int square, const int offsets[][2], int count) {
+    Bitboard attacks = 0;
+    for (int i = 0; i < count; ++i) {
+        int file = fileOf(square) + offsets[i][0];
+        int rank = rankOf(square) + offsets[i][1];
+        if (onBoard(file, rank)) attacks |= squareBB(makeSquare(file, rank));
+    }
+    return attacks;
+}
+
+// Slow ray walk, only used to fill the tables
+Bitboard slidingAttacks(int square, Bitboard occupied, const int directions[4][2]) {
+    Bitboard attacks = 0;
+    for (int i = 0; i < 4; ++i) {
+        int file = fileOf(square) + directions[i][0];
+        int rank = rankOf(square) + directions[i][1];
+        while (onBoard(file, rank)) {
+            Bitboard b = squareBB(makeSquare(file, rank));
+            attacks |= b;
+            if (occupied & b) break;
+            file += directions[i][0];
+            rank += directions[i][1];
+        }
+    }
+    return attacks;
+}
+
+// xorshift64* generator; a fixed seed keeps the magic search deterministic
+class Random {
+public:
+    explicit Random(uint64_t seed) : state(seed) {}
+    uint64_t next() {
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        return state * 2685821657736338717ULL;
+    }
+    // Magics with few set bits are found much faster
+    uint64_t sparse() { return next() & next() & next(); }
+
+private:
+    uint64_t state;
+};
+
+void initMagics(Magic magics[64], Bitboard* table, const int directions[4][2]) {
+    const Bitboard rank1 = 0xFFULL, rank8 = rank1 << 56;
+    const Bitboard fileA = 0x0101010101010101ULL, fileH = fileA << 7;
+    Bitboard reference[4096];
+#ifndef USE_PEXT
+    // Per-rank seeds that are known to find magics quickly
+    const uint64_t seeds[8] = { 728, 10316, 55013, 32803, 12281, 15100, 16645, 255 };
+    Bitboard occupancy[4096];
+    int epoch[4096] = {};
+    int attempt = 0;
+#endif
+
+    for (int square = 0; square < 64; ++square) {
+        // Board edges never block a slider, unless the slider is standing on that edge
+        Bitboard edges = ((rank1 | rank8) & ~(rank1 << (8 * rankOf(square))))
+                       | ((fileA | fileH) & ~(fileA << fileOf(square)));
+
+        Magic& m = magics[square];
+        m.mask = slidingAttacks(square, 0, directions) & ~edges;
+        m.shift = 64 - popcount(m.mask);
+        m.attacks = square == 0 ? table : magics[square - 1].attacks + (1 << (64 - magics[square - 1].shift));
+
+        // Enumerate every subset of the mask (Carry-Rippler) with its attack set
+        int size = 0;
+        Bitboard b = 0;
+        do {
+            reference[size] = slidingAttacks(square, b, directions);
+#ifdef USE_PEXT
+            m.attacks[_pext_u64(b, m.mask)] = reference[size];
+#else
+            occupancy[size] = b;
+#endif
+            size++;
+            b = (b - m.mask) & m.mask;
+        } while (b);
+
+#ifndef USE_PEXT
+        // Try random candidates until one maps every subset without a destructive collision
+        Random random(seeds[rankOf(square)]);
+        for (int i = 0; i < size; ) {
+            for (m.magic = 0; popcount((m.magic * m.mask) >> 56) < 6; ) {
+                m.magic = random.sparse();
+            }
+            ++attempt;
+            for (i = 0; i < size; ++i) {
+                unsigned idx = m.index(occupancy[i]);
+                if (epoch[idx] < attempt) {
+                    epoch[idx] = attempt;
+                    m.attacks[idx] = reference[i];
+                } else if (m.attacks[idx] != reference[i]) {
+                    break;
+                }
+            }
+        }
+#endif
+    }
+}
+
+bool initTables() {
+    const int knightOffsets[8][2] = {
+        {1, 2}, {2, 1}, {2, -1}, {1, -2}, {-1, -2}, {-2, -1}, {-2, 1}, {-1, 2}
+    };
+    const int kingOffsets[8][2] = {
+        {0, 1}, {1, 1}, {1, 0}, {1, -1}, {0, -1}, {-1, -1}, {-1, 0}, {-1, 1}
+    };
+    const int whitePawnOffsets[2][2] = { {-1, 1}, {1, 1} };
+    const int blackPawnOffsets[2][2] = { {-1, -1}, {1, -1} };
+
+    for (int square = 0; square < 64; ++square) {
+        knightAttackTable[square] = leaperAttacks(square, knightOffsets, 8);
+        kingAttackTable[square] = leaperAttacks(square, kingOffsets, 8);
+        pawnAttackTable[0][square] = leaperAttacks(square, whitePawnOffsets, 2);
+        pawnAttackTable[1][square] = leaperAttacks(square, blackPawnOffsets, 2);
+    }
+
+    initMagics(rookMagics, rookTable, rookDirections);
+    initMagics(bishopMagics, bishopTable, bishopDirections);
+
+    // Squares on a shared rank, file or diagonal, built from the slider tables above
+    for (int a = 0; a < 64; ++a) {
+        for (int b = 0; b < 64; ++b) {
+            betweenTable[a][b] = lineTable[a][b] = 0;
+            if (a == b) continue;
+            if (rookAttacks(a, 0) & squareBB(b)) {
+                lineTable[a][b] = (rookAttacks(a, 0) & rookAttacks(b, 0)) | squareBB(a) | squareBB(b);
+                betweenTable[a][b] = rookAttacks(a, squareBB(b)) & rookAttacks(b, squareBB(a));
+            } else if (bishopAttacks(a, 0) & squareBB(b)) {
+                lineTable[a][b] = (bishopAttacks(a, 0) & bishopAttacks(b, 0)) | squareBB(a) | squareBB(b);
+                betweenTable[a][b] = bishopAttacks(a, squareBB(b)) & bishopAttacks(b, squareBB(a));
+            }
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+void initBitboards() {
+    // Function-local static: initialised exactly once, even if several threads get here together
+    static const bool initialised = initTables();
+    (void)initialised;
+}
@@ -0,0 +1,110 @@
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+#include "types.h"
+
+#if defined(__BMI2__) && !defined(NO_PEXT)
+#include <immintrin.h>
+#define USE_PEXT
+#endif
+
+// MSVC has no __builtin bit functions; its intrinsics need an x64 CPU with POPCNT
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+inline Bitboard squareBB(int square) {
+    return Bitboard(1) << square;
+}
+
+inline int popcount(Bitboard b) {
+#if defined(_MSC_VER)
+    return static_cast<int>(__popcnt64(b));
+#else
+    return __builtin_popcountll(b);
+#endif
+}
+
+// Index of the least significant set bit, b must be non-zero
+inline int lsb(Bitboard b) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward64(&index, b);
+    return static_cast<int>(index);
+#else
+    return __builtin_ctzll(b);
+#endif
+}
+
+// Returns the least significant square and clears it from b
+inline int popLsb(Bitboard& b) {
+    int square = lsb(b);
+    b &= b - 1;
+    return square;
+}
+
+// Precomputes the attack tables below. Safe to call more than once; only the first call does any work.
+void initBitboards();
+
+// Sliding attacks are looked up with a (magic or PEXT) hash of the relevant blockers
+struct Magic {
+    Bitboard mask;
+    Bitboard magic;
+    Bitboard* attacks;
+    unsigned shift;
+
+    unsigned index(Bitboard occupied) const {
+#ifdef USE_PEXT
+        return static_cast<unsigned>(_pext_u64(occupied, mask));
+#else
+        return static_cast<unsigned>(((occupied & mask) * magic) >> shift);
+#endif
+    }
+};
+
+extern Magic rookMagics[64];
+extern Magic bishopMagics[64];
+extern Bitboard knightAttackTable[64];
+extern Bitboard kingAttackTable[64];
+extern Bitboard pawnAttackTable[2][64];
+extern Bitboard betweenTable[64][64];
+extern Bitboard lineTable[64][64];
+
+inline Bitboard rookAttacks(int square, Bitboard occupied) {
+    const Magic& m = rookMagics[square];
+    return m.attacks[m.index(occupied)];
+}
+
+inline Bitboard bishopAttacks(int square, Bitboard occupied) {
+    const Magic& m = bishopMagics[square];
+    return m.attacks[m.index(occupied)];
+}
+
+inline Bitboard queenAttacks(int square, Bitboard occupied) {
+    return rookAttacks(square, occupied) | bishopAttacks(square, occupied);
+}
+
+inline Bitboard knightAttacks(int square) {
+    return knightAttackTable[square];
+}
+
+inline Bitboard kingAttacks(int square) {
+    return kingAttackTable[square];
+}
+
+// Squares attacked by a pawn of the given colour standing on square
+inline Bitboard pawnAttacks(PieceColour colour, int square) {
+    return pawnAttackTable[static_cast<int>(colour)][square];
+}
+
+// Squares strictly between a and b if they share a line, otherwise empty
+inline Bitboard between(int a, int b) {
+    return betweenTable[a][b];
+}
+
+// The whole rank, file or diagonal through a and b, or empty if they are not aligned
+inline Bitboard line(int a, int b) {
+    return lineTable[a][b];
+}
+
+#endif // BITBOARD_H
@@ -3,84 +3,81 @@
 
 #include <SFML/Graphics.hpp>
 #include <vector>
-#include "piece.h"
-#include <unordered_set>
+#include "piece_sprite.h"
+#include "position.h"
+#include "move.h"
 
 class Board {
 public:
     Board(int squareSize, sf::Color lightColor, sf::Color darkColor);
     void draw(sf::RenderWindow& window);
-    void addPiece(const sf::Texture& texture, int x, int y, PieceColour colour, PieceType type);
+    void addPiece(const sf::IntRect& textureRect, int x, int y, PieceColour colour, PieceType type);
     void handleEvent(sf::Event& event, sf::RenderWindow& window);
     void selectPiece(const sf::Vector2f& mousePos);
-    bool isValidMove(Piece &piece, sf::Vector2i targetPos);
-    std::vector<std::string> generateLegalMoves();
-    bool isLegalMove(const std::string &move);
+    // Legal moves of the side to move, cached by position key
+    const MoveList& getLegalMoves();
+    bool isLegalMove(int from, int to);
+
+    // For the engine player: the game to think about and a way to play its answer.
+    // The start position and the moves since let the engine see repetitions.
+    const std::string& getStartFen() const { return startFen; }
+    const std::vector<Move>& getMoves() const { return moves; }
+    PieceColour getSideToMove() const { return isWhiteTurn ? PieceColour::White : PieceColour::Black; }
+    bool isGameOver() const { return gameOver; }
+    void playMove(Move move);
 
 private:
     int squareSize;
     sf::Color lightColor;
     sf::Color darkColor;
-    std::vector<sf::RectangleShape> squares;
-    std::vector<Piece> pieces;
-
-    Piece* selectedPiece = nullptr;
-    sf::Vector2i originalPosition;
+    // The squares never change, so they are drawn once into a texture and blitted every frame
+    sf::RenderTexture squaresTexture;
+    sf::Sprite squaresSprite;
+    void renderSquares();
+
+    std::vector<PieceSprite> pieces;
+    // Every piece as two triangles into the atlas, rebuilt only when piecesChanged is set
+    sf::VertexArray pieceVertices;
+    bool piecesChanged = true;
+    Position position;
+    std::string startFen;
+    std::vector<Move> moves;
+
+    PieceSprite* selectedPiece = nullptr;
     bool isDragging = false;
 
     sf::Vector2i snapToSquare(const sf::Vector2f& position);
-    bool isWithinBounds(const sf::Vector2f& position);
 
     bool highlightSquare = false;
     int highlightedX = -1;
     int highlightedY = -1;
 
     bool isWhiteTurn = true;
-    void endTurn();
-
-    void capturePiece(Piece &piece);
 
-    std::unordered_set<std::string> legalMoves;
+    // Cache behind getLegalMoves, valid while the position key equals legalMovesKey
+    MoveList legalMoves;
+    uint64_t legalMovesKey = 0;
+    bool legalMovesValid = false;
+    // Destination squares of the cached moves by origin square, for constant time lookups
+    Bitboard legalTargets[64] = {};
+    Bitboard getLegalTargets(int from);
     void parseFen(const std::string &fen);
+    void loadFromPosition();
     void initializeBoard();
 
-    sf::Texture whiteRookTexture, whiteKnightTexture, whiteBishopTexture, whiteQueenTexture, whiteKingTexture, whitePawnTexture;
-    sf::Texture blackRookTexture, blackKnightTexture, blackBishopTexture, blackQueenTexture, blackKingTexture, blackPawnTexture;
-
-
-    std::vector<std::string> generatePawnMoves(const Piece& piece);
-    std::vector<std::string> generateRookMoves(const Piece& piece);
-    std::vector<std::string> generateKnightMoves(const Piece& piece);
-    std::vector<std::string> generateBishopMoves(const Piece& piece);
-    std::vector<std::string> generateQueenMoves(const Piece& piece);
-    std::vector<std::string> generateKingMoves(const Piece& piece);
+    // All twelve piece images in one texture, so the pieces are drawn in a single call
+    sf::Texture atlas;
+    // Where each piece image sits in the atlas, by colour and type
+    sf::IntRect textureRects[2][6];
+    void buildAtlas();
+    const sf::IntRect& getTextureRect(PieceType type, PieceColour colour) const;
 
+    int toSquare(int col, int row) const;
     bool isValidPosition(int col, int row);
-    bool isEmpty(int col, int row);
-    bool isEnemyPiece(int col, int row, PieceColour colour);
-    std::string moveToString(sf::Vector2i from, sf::Vector2i to);
 
     bool isKingInCheck(PieceColour colour);
-    bool isPositionAttacked(int col, int row, PieceColour colour);
-    bool simulateMoveAndCheck(Piece& piece, sf::Vector2i targetPos);
-
-    //castling
-    bool whiteKingMoved = false;
-    bool whiteKingsideRookMoved = false;
-    bool whiteQueensideRookMoved = false;
-
-    bool blackKingMoved = false;
-    bool blackKingsideRookMoved = false;
-    bool blackQueensideRookMoved = false;
-
-    //en passant
-    sf::Vector2i enPassantTarget = sf::Vector2i(-500, -500);   
-
-    bool canCastleKingside(PieceColour colour);
-    bool canCastleQueenside(PieceColour colour);
-    void performCastling(Piece& king, sf::Vector2i targetPos);
 
-    bool isCheckmate(PieceColour colour);
+    void updateGameOver();
     bool gameOver = false;
     std::string gameOverMessage;
     sf::Vector2i checkmateKingPosition;
@@ -1,231 +1,215 @@
 #include "engine.h"
-#include <iostream>
-#include <sstream>
+#include "search.h"
+#include "movegen.h"
+#include "log.h"
+#include <algorithm>
+#include <thread>
 
-Engine::Engine() : isWhiteTurn(true) {
-    for (int i = 0; i < 8; ++i) {
-        for (int j = 0; j < 8; ++j) {
-            board[i][j] = Piece();
-        }
+namespace {
+
+// Default margin kept back from the clock for move transmission and process overhead
+constexpr int DefaultMoveOverhead = 10;
+
+} // namespace
+
+Engine::Engine() : useNnue(false), moveOverhead(DefaultMoveOverhead), stopRequested(false), pondering(false), softTimeLimit(0), hardTimeLimit(0) {
+    setThreads(1);
+}
+
+// Out of line so that SearchThread is a complete type where the threads are destroyed
+Engine::~Engine() = default;
+
+bool Engine::setBoardState(std::string_view fen, FenError* error) {
+    return parseFen(fen, position, error);
+}
+
+Move Engine::parseMove(const std::string& uciMove) const {
+    MoveList moves;
+    generateLegalMoves(position, moves);
+    for (Move move : moves) {
+        if (move.toString() == uciMove) return move;
     }
+    return Move::none();
 }
 
-void Engine::setBoardState(const std::string &fen) {
-    parseFen(fen);
+bool Engine::applyMove(const std::string& uciMove) {
+    Move move = parseMove(uciMove);
+    if (move.isNone()) return false;
+    position.makeMove(move);
+    return true;
 }
 
-std::string Engine::getBestMove() {
-    return searchBestMove(3);
+std::string Engine::getBestMove(const SearchLimits& limits) {
+    return search(limits).toString();
 }
 
-void Engine::parseFen(const std::string& fen) {
-    std::istringstream iss(fen);
-    std::string boardPart, turnPart;
-    iss >> boardPart >> turnPart;
+void Engine::stop() {
+    stopRequested = true;
+}
 
-    int row = 7, col = 0;
-    for(char c : boardPart) {
-        if (c == '/') {
-            row--;
-            col = 0;
-        } else if (isdigit(c)) {
-            col += c - '0';
-        }
-        else {
-            PieceType type;
-            PieceColour colour = isupper(c) ? PieceColour::White : PieceColour::Black;
-            switch (tolower(c)) {
-                case 'p': type = PieceType::Pawn; break;
-                case 'r': type = PieceType::Rook; break;
-                case 'n': type = PieceType::Knight; break;
-                case 'b': type = PieceType::Bishop; break;
-                case 'q': type = PieceType::Queen; break;
-                case 'k': type = PieceType::King; break;
-                default: type = PieceType::Pawn; break; // Default case
-            }
-            board[col][row] = Piece(type, colour, col, row);
-            col++;
-        }
-    }
+void Engine::ponderhit() {
+    // The clock has been running since the search started, so the time limits apply at once
+    pondering = false;
 }
 
-std::string Engine::generateFen() const {
-    std::ostringstream oss;
-    for (int row = 0; row >= 0; --row) {
-        int emptyCount = 0;
-        for (int col = 0; col < 8; ++col) {
-            if (board[col][row].getType() == PieceType::None) {
-                emptyCount++;
-            } else {
-                if (emptyCount > 0) {
-                    oss << emptyCount;
-                    emptyCount = 0;
-                }
-                char pieceChar;
-                switch (board[col][row].getType()) {
-                    case PieceType::Pawn: pieceChar = 'p'; break;
-                    case PieceType::Rook: pieceChar = 'r'; break;
-                    case PieceType::Knight: pieceChar = 'n'; break;
-                    case PieceType::Bishop: pieceChar = 'b'; break;
-                    case PieceType::Queen: pieceChar = 'q'; break;
-                    case PieceType::King: pieceChar = 'k'; break;
-                    default: pieceChar = ' '; break; // Default case
-                }
-                if (board[col][row].getColour() == PieceColour::White) {
-                    pieceChar = toupper(pieceChar);
-                }
-
-                oss << pieceChar;
-            }
-        }
-        if (emptyCount > 0) {
-            oss << emptyCount;
-        }
-        if (row > 0) {
-            oss << '/';
-        }
+void Engine::setThreads(int count) {
+    count = std::max(1, std::min(count, MaxThreads));
+    threads.clear();
+    for (int id = 0; id < count; ++id) {
+        threads.push_back(std::make_unique<SearchThread>(*this, id));
     }
-    oss << ' ' << (isWhiteTurn ? 'w' : 'b');
-    return oss.str();
-}
-
-std::vector<std::string> Engine::generateLegalMoves() {
-    std::vector<std::string> allMoves;
-    // for (int row = 0; row < 8; ++row) {
-    //     for (int col = 0; col < 8; ++col) {
-    //         if ((isWhiteTurn && board[col][row].getColour() == PieceColour::White) || (!isWhiteTurn && board[col][row].getColour() == PieceColour::Black)) {
-    //             std::vector<std::string> pieceMoves;
-    //             switch (board[col][row].getType()) {
-    //                 case PieceType::Pawn:
-    //                     pieceMoves = generatePawnMoves(col, row);
-    //                     break;
-    //                 case PieceType::Rook:
-    //                     pieceMoves = generateRookMoves(col, row);
-    //                     break;
-    //                 case PieceType::Knight:
-    //                     pieceMoves = generateKnightMoves(col, row);
-    //                     break;
-    //                 case PieceType::Bishop:
-    //                     pieceMoves = generateBishopMoves(col, row);
-    //                     break;
-    //                 case PieceType::Queen:
-    //                     pieceMoves = generateQueenMoves(col, row);
-    //                     break;
-    //                 case PieceType::King:
-    //                     pieceMoves = generateKingMoves(col, row);
-    //                     break;
-    //                 default:
-    //                     break;
-    //             }
-    //             allMoves.insert(allMoves.end(), pieceMoves.begin(), pieceMoves.end());
-    //         }
-    //     }
-    // }
-    return allMoves;
-}
-
-int Engine::evaluateBoard() const {
-    // Implement a basic evaluation function
-    int score = 0;
-    for (int row = 0; row < 8; ++row) {
-        for (int col = 0; col < 8; ++col) {
-            switch (board[col][row].getType()) {
-                case PieceType::Pawn: score += (board[col][row].getColour() == PieceColour::White) ? 1 : -1; break;
-                case PieceType::Rook: score += (board[col][row].getColour() == PieceColour::White) ? 5 : -5; break;
-                case PieceType::Knight: score += (board[col][row].getColour() == PieceColour::White) ? 3 : -3; break;
-                case PieceType::Bishop: score += (board[col][row].getColour() == PieceColour::White) ? 3 : -3; break;
-                case PieceType::Queen: score += (board[col][row].getColour() == PieceColour::White) ? 9 : -9; break;
-                case PieceType::King: score += (board[col][row].getColour() == PieceColour::White) ? 100 : -100; break;
-                default: break;
-            }
-        }
-    }
-    return score;
 }
 
-std::string Engine::searchBestMove(int depth) {
-    // Implement a basic minimax search with alpha-beta pruning
-    int bestScore = -10000;
-    std::string bestMove;
-    std::vector<std::string> legalMoves = generateLegalMoves();
-    for (const std::string& move : legalMoves) {
-        // Make the move
-        // ...
+uint64_t Engine::getNodes() const {
+    uint64_t total = 0;
+    for (const auto& thread : threads) total += thread->getNodes();
+    return total;
+}
 
-        // Evaluate the move
-        int score = -evaluateBoard();
+bool Engine::setEvalFile(const std::string& path) {
+    return network.load(path);
+}
 
-        // Undo the move
-        // ...
+void Engine::setHashSize(size_t megabytes) {
+    tt.resize(megabytes);
+}
 
-        if (score > bestScore) {
-            bestScore = score;
-            bestMove = move;
-        }
-    }
-    return bestMove;
+void Engine::clearHash() {
+    tt.clear();
+}
+
+std::string Engine::generateFen() const {
+    return toFen(position);
 }
 
-// Implement move generation functions (generatePawnMoves, generateRookMoves, etc.) here
+// Scored from the side to move's point of view, as negamax expects.
+// Blends the middlegame and endgame sums by how much material is left; both are
+// maintained by make/unmake, so this does not look at the board at all.
+int Engine::evaluateBoard(const Position& position) {
+    int phase = std::min(position.getPhase(), MaxPhase);
+    int score = (position.getMidgameScore() * phase + position.getEndgameScore() * (MaxPhase - phase)) / MaxPhase;
+    return position.getSideToMove() == PieceColour::White ? score : -score;
+}
 
-// Example implementation for pawn moves
-std::vector<std::string> Engine::generatePawnMoves(int x, int y) {
-    std::vector<std::string> moves;
-    // int direction = (board[x][y].getColour() == PieceColour::White) ? 1 : -1;
+void Engine::startClock() {
+    startTime = std::chrono::steady_clock::now();
+    softTimeLimit = 0;
+    hardTimeLimit = 0;
 
-    // // Move forward one square
-    // if (isValidPosition(x, y + direction) && board[x][y + direction].getType() == PieceType::None) {
-    //     moves.push_back(moveToString(sf::Vector2i(x, y), sf::Vector2i(x, y + direction)));
+    if (limits.movetime > 0) {
+        softTimeLimit = hardTimeLimit = std::max<int64_t>(1, limits.movetime - moveOverhead);
+        return;
+    }
 
-    //     // Move forward two squares from starting position
-    //     if ((board[x][y].getColour() == PieceColour::White && y == 1) || (board[x][y].getColour() == PieceColour::Black && y == 6)) {
-    //         if (isValidPosition(x, y + 2 * direction) && board[x][y + 2 * direction].getType() == PieceType::None) {
-    //             moves.push_back(moveToString(sf::Vector2i(x, y), sf::Vector2i(x, y + 2 * direction)));
-    //         }
-    //     }
-    // }
+    bool white = position.getSideToMove() == PieceColour::White;
+    int64_t remaining = white ? limits.wtime : limits.btime;
+    int64_t increment = white ? limits.winc : limits.binc;
+    if (remaining <= 0 || limits.infinite) return;
+
+    // Spread the clock over the moves left, and allow a single move to overrun its share
+    // when an iteration is still in progress
+    int movesToGo = limits.movestogo > 0 ? std::min(limits.movestogo, 50) : 30;
+    int64_t available = std::max<int64_t>(1, remaining - moveOverhead);
+    softTimeLimit = std::min(available, available / movesToGo + increment * 3 / 4);
+    hardTimeLimit = std::min(available, softTimeLimit * 4);
+}
+
+int64_t Engine::elapsed() const {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+// Called by the main thread only; the helpers just watch stopRequested
+void Engine::checkLimits() {
+    if ((limits.nodes && getNodes() >= limits.nodes)
+        || (!pondering && hardTimeLimit && elapsed() >= hardTimeLimit)) {
+        stopRequested = true;
+    }
+}
 
-    // // Capture diagonally
-    // if (isValidPosition(x + 1, y + direction) && board[x + 1][y + direction].getColour() != board[x][y].getColour() && board[x + 1][y + direction].getType() != PieceType::None) {
-    //     moves.push_back(moveToString(sf::Vector2i(x, y), sf::Vector2i(x + 1, y + direction)));
-    // }
-    // if (isValidPosition(x - 1, y + direction) && board[x - 1][y + direction].getColour() != board[x][y].getColour() && board[x - 1][y + direction].getType() != PieceType::None) {
-    //     moves.push_back(moveToString(sf::Vector2i(x, y), sf::Vector2i(x - 1, y + direction)));
-    // }
+bool Engine::isSoftLimitReached() const {
+    return !pondering && softTimeLimit && elapsed() >= softTimeLimit;
+}
 
-    // // En passant capture
-    // if (isValidPosition(x + 1, y + direction) && sf::Vector2i(x + 1, y + direction) == enPassantTarget) {
-    //     moves.push_back(moveToString(sf::Vector2i(x, y), sf::Vector2i(x + 1, y + direction)));
-    // }
-    // if (isValidPosition(x - 1, y + direction) && sf::Vector2i(x - 1, y + direction) == enPassantTarget) {
-    //     moves.push_back(moveToString(sf::Vector2i(x, y), sf::Vector2i(x - 1, y + direction)));
-    // }
+void Engine::prepareSearch(const SearchLimits& searchLimits) {
+    limits = searchLimits;
+    stopRequested = false;
+    pondering = limits.ponder;
+    startClock();
+}
 
-    return moves;
+Move Engine::search(const SearchLimits& searchLimits) {
+    prepareSearch(searchLimits);
+    return search();
 }
 
+// Never clears stopRequested, which may already have been raised by the time this runs
+Move Engine::search() {
+    tt.newSearch();
+    CHESS_TRACE("search %s", toFen(position).c_str());
 
-//testing fen generation and parsing
+    for (auto& thread : threads) thread->setPosition(position);
 
-void testFENConversion(const std::string& fen) {
-    Engine engine;
-    engine.setBoardState(fen);
-    std::string generatedFEN = engine.generateFen();
+    // Lazy SMP: the helpers search the same root and only share the transposition table
+    std::vector<std::thread> helpers;
+    for (size_t i = 1; i < threads.size(); ++i) {
+        helpers.emplace_back(&SearchThread::iterativeDeepening, threads[i].get());
+    }
+    threads[0]->iterativeDeepening();
 
-    std::cout << "Original FEN: " << fen << std::endl;
-    std::cout << "Generated FEN: " << generatedFEN << std::endl;
+    // The best move may only be sent once the GUI has asked for it
+    while ((limits.infinite || pondering) && !stopRequested) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    stopRequested = true;
+    for (std::thread& helper : helpers) helper.join();
+
+    // Prefer a helper only if it finished a deeper iteration without a worse score
+    const SearchThread* best = threads[0].get();
+    for (size_t i = 1; i < threads.size(); ++i) {
+        const SearchThread* thread = threads[i].get();
+        if (!thread->getBestMove().isNone()
+            && thread->getCompletedDepth() > best->getCompletedDepth()
+            && thread->getBestScore() >= best->getBestScore()) {
+            best = thread;
+        }
+    }
+    if constexpr (StatsEnabled) {
+        // Main thread first, so the iteration counts are its own
+        stats = threads[0]->getStats();
+        for (size_t i = 1; i < threads.size(); ++i) stats.merge(threads[i]->getStats());
+    }
+    CHESS_TRACE("bestmove %s depth %d", best->getBestMove().toString().c_str(), best->getCompletedDepth());
+    return best->getBestMove();
+}
 
-    if (fen == generatedFEN) {
-        std::cout << "Test passed!" << std::endl;
-    } else {
-        std::cout << "Test failed!" << std::endl;
+std::vector<Move> Engine::extractPv(Move first, int maxLength) const {
+    std::vector<Move> pv;
+    Position walk = position;
+    Move move = first;
+    // A hash move may be stale or lead into a cycle, so each one is checked and the length capped
+    while ((int)pv.size() < maxLength && isPseudoLegal(walk, move) && isLegal(walk, move)) {
+        pv.push_back(move);
+        walk.makeMove(move);
+        TTEntry entry;
+        if (!tt.probe(walk.getKey(), entry)) break;
+        move = entry.move;
     }
+    return pv;
 }
 
-int main() {
-    std::string fen = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
-    testFENConversion(fen);
+Move Engine::getPonderMove(Move bestMove) const {
+    std::vector<Move> pv = extractPv(bestMove, 2);
+    return pv.size() > 1 ? pv[1] : Move::none();
+}
 
-    // Add more test cases as needed
-    return 0;
-}
\ No newline at end of file
+void Engine::reportIteration(int depth, int score, Move bestMove) {
+    if (!infoCallback) return;
+    SearchInfo info;
+    info.depth = depth;
+    info.score = score;
+    info.nodes = getNodes();
+    info.time = elapsed();
+    info.hashfull = tt.hashfull();
+    info.pv = extractPv(bestMove, depth);
+    infoCallback(info);
+}
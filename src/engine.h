@@ -1,32 +1,172 @@
 #ifndef ENGINE_H
 #define ENGINE_H
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
 #include <string>
 #include <vector>
-#include "piece.h"
+#include "position.h"
+#include "fen.h"
+#include "move.h"
+#include "tt.h"
+#include "nnue.h"
+#include "stats.h"
+
+constexpr int MaxPly = 128;
+constexpr int Infinite = 32001;
+constexpr int MateScore = 32000;
+// Scores beyond this are forced mates
+constexpr int MateBound = MateScore - MaxPly;
+
+// Moves (not plies) to mate for a score beyond MateBound; negative when the side to move is mated
+inline int mateInMoves(int score) {
+    return score > 0 ? (MateScore - score + 1) / 2 : -(MateScore + score) / 2;
+}
+constexpr int MaxThreads = 256;
+
+class SearchThread;
+
+// Limits for one search; a zero means "no limit" for that field
+struct SearchLimits {
+    int depth = 0;
+    uint64_t nodes = 0;
+    int movetime = 0;
+    int wtime = 0;
+    int btime = 0;
+    int winc = 0;
+    int binc = 0;
+    int movestogo = 0;
+    bool infinite = false;
+    // Search on the opponent's time; limits only start to count after ponderhit()
+    bool ponder = false;
+    // Stop once a mate in this many moves is found
+    int mate = 0;
+    // Only these root moves are searched, if any are given
+    std::vector<Move> searchMoves;
+};
+
+// Progress report after each completed iteration of the main search thread
+struct SearchInfo {
+    int depth;
+    // Centipawns from the side to move's point of view, or a mate score beyond MateBound
+    int score;
+    uint64_t nodes;
+    int64_t time;
+    int hashfull;
+    std::vector<Move> pv;
+};
+
+// Switches and tuning values for the selective parts of the search, so that each can be
+// measured on its own. Depths are in plies, margins in centipawns.
+struct SearchParams {
+    bool nullMove = true;
+    int nullMoveMinDepth = 3;
+    // Depth reduction of the null-move search: base + depth / divisor
+    int nullMoveReduction = 3;
+    int nullMoveDepthDivisor = 4;
+    // From this depth a null-move cutoff is only trusted after a reduced normal search agrees
+    int nullMoveVerifyDepth = 10;
+
+    bool lateMoveReductions = true;
+    int lmrMinDepth = 3;
+    // Moves searched at full depth before reductions start
+    int lmrMinMoves = 3;
+    // Reduction = base + log(depth) * log(moveCount) / divisor, both in hundredths
+    int lmrBase = 75;
+    int lmrDivisor = 225;
+    // Every this many points of history lowers or raises the reduction by one ply
+    int lmrHistoryDivisor = 4096;
+
+    bool reverseFutility = true;
+    int reverseFutilityMaxDepth = 6;
+    int reverseFutilityMargin = 80;
+
+    bool futility = true;
+    int futilityMaxDepth = 6;
+    int futilityMarginBase = 100;
+    int futilityMarginPerDepth = 80;
+
+    bool checkExtensions = true;
+};
 
 class Engine {
 public:
     Engine();
-    void setBoardState(const std::string &fen);
-    std::string getBestMove();
+    ~Engine();
+    // Leaves the board unchanged and fills in error if the FEN is invalid
+    bool setBoardState(std::string_view fen, FenError* error = nullptr);
+    // The legal move written as uciMove in the current position, or Move::none()
+    Move parseMove(const std::string& uciMove) const;
+    // Plays a move given in UCI notation on the current position; false if it is not legal there
+    bool applyMove(const std::string& uciMove);
+    std::string getBestMove(const SearchLimits& limits);
+    // Sets up a search without running it. A search run on another thread must be prepared on
+    // the thread that may stop it, so a stop() sent before the search thread starts is kept.
+    void prepareSearch(const SearchLimits& limits);
+    // Runs the prepared search
+    Move search();
+    Move search(const SearchLimits& limits);
+    // Safe to call from another thread while search() is running
+    void stop();
+    void ponderhit();
+    // Called on the searching thread after every completed iteration
+    void setInfoCallback(std::function<void(const SearchInfo&)> callback) { infoCallback = std::move(callback); }
+    // The move expected in reply to bestMove, read from the hash table; Move::none() if unknown
+    Move getPonderMove(Move bestMove) const;
+    // Milliseconds kept back from the clock for communication delays
+    void setMoveOverhead(int milliseconds) { moveOverhead = milliseconds; }
+    // Number of search threads, the calling thread included; not while searching
+    void setThreads(int count);
+    int getThreads() const { return static_cast<int>(threads.size()); }
+    // Loads the network used when NNUE evaluation is switched on; false if the file is unusable
+    bool setEvalFile(const std::string& path);
+    // Has no effect until a network has been loaded
+    void setUseNnue(bool enabled) { useNnue = enabled; }
+    bool isUsingNnue() const { return useNnue && network.isLoaded(); }
+    // Not while searching
+    void setSearchParams(const SearchParams& searchParams) { params = searchParams; }
+    const SearchParams& getSearchParams() const { return params; }
+    void setHashSize(size_t megabytes);
+    void clearHash();
+    int getHashfull() const { return tt.hashfull(); }
+    uint64_t getNodes() const;
+    // Statistics of the last search, all threads merged; empty unless compiled with CHESS_STATS
+    const SearchStats& getStats() const { return stats; }
     std::string generateFen() const;
 
 private: 
-    Piece board[8][8];
-    bool isWhiteTurn;
-
-    void parseFen(const std::string &fen);
-    std::vector<std::string> generateLegalMoves();
-    int evaluateBoard() const;
-    std::string searchBestMove(int depth);
-
-    // Move generation functions
-    std::vector<std::string> generatePawnMoves(int x, int y);
-    std::vector<std::string> generateRookMoves(int x, int y);
-    std::vector<std::string> generateKnightMoves(int x, int y);
-    std::vector<std::string> generateBishopMoves(int x, int y);
-    std::vector<std::string> generateQueenMoves(int x, int y);
-    std::vector<std::string> generateKingMoves(int x, int y);
+    friend class SearchThread;
+
+    Position position;
+    TranspositionTable tt;
+    Network network;
+    bool useNnue;
+    SearchParams params;
+    int moveOverhead;
+    std::function<void(const SearchInfo&)> infoCallback;
+    SearchStats stats;
+
+    // Search state shared by all threads
+    SearchLimits limits;
+    std::atomic<bool> stopRequested;
+    std::atomic<bool> pondering;
+    std::chrono::steady_clock::time_point startTime;
+    int64_t softTimeLimit;
+    int64_t hardTimeLimit;
+    // threads[0] runs on the caller of search(), the others are helpers
+    std::vector<std::unique_ptr<SearchThread>> threads;
+
+    static int evaluateBoard(const Position& position);
+
+    void startClock();
+    int64_t elapsed() const;
+    void checkLimits();
+    bool isSoftLimitReached() const;
+    // Follows hash moves from the root, starting with first
+    std::vector<Move> extractPv(Move first, int maxLength) const;
+    void reportIteration(int depth, int score, Move bestMove);
 };
-#endif // ENGINE_H
\ No newline at end of file
+#endif // ENGINE_H
@@ -0,0 +1,39 @@
+#include "engine_player.h"
+
+EnginePlayer::EnginePlayer(int movetime) {
+    limits.movetime = movetime;
+}
+
+EnginePlayer::~EnginePlayer() {
+    cancel();
+}
+
+void EnginePlayer::start(const std::string& fen, const std::vector<Move>& moves) {
+    if (thinking || !engine.setBoardState(fen)) return;
+    for (Move move : moves) {
+        if (!engine.applyMove(move.toString())) return;
+    }
+    thinking = true;
+    finished.store(false, std::memory_order_relaxed);
+    // Prepared here so that a cancel() right after start() stops the search
+    engine.prepareSearch(limits);
+    worker = std::thread([this] {
+        bestMove = engine.search();
+        finished.store(true, std::memory_order_release);
+    });
+}
+
+bool EnginePlayer::takeMove(Move& move) {
+    if (!thinking || !finished.load(std::memory_order_acquire)) return false;
+    worker.join();
+    thinking = false;
+    move = bestMove;
+    return true;
+}
+
+void EnginePlayer::cancel() {
+    if (!thinking) return;
+    engine.stop();
+    worker.join();
+    thinking = false;
+}
@@ -0,0 +1,40 @@
+#ifndef ENGINE_PLAYER_H
+#define ENGINE_PLAYER_H
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+#include "engine.h"
+
+// Plays one side in the board window. The search runs on a worker thread so the window
+// keeps handling events while the engine thinks; the GUI collects the move with takeMove.
+class EnginePlayer {
+public:
+    explicit EnginePlayer(int movetime);
+    ~EnginePlayer();
+    EnginePlayer(const EnginePlayer&) = delete;
+    EnginePlayer& operator=(const EnginePlayer&) = delete;
+
+    // Starts thinking about the position after moves from fen, replayed so the engine knows the
+    // game's history; ignored while a search is already running
+    void start(const std::string& fen, const std::vector<Move>& moves);
+    // True from start() until the move has been taken or the search cancelled
+    bool isThinking() const { return thinking; }
+    // Hands over the move once the search has finished; false while still thinking.
+    // The move is Move::none() if the position had no legal moves.
+    bool takeMove(Move& move);
+    // Stops the search and throws its result away
+    void cancel();
+
+private:
+    Engine engine;
+    SearchLimits limits;
+    std::thread worker;
+    bool thinking = false;
+    // Set by the worker once bestMove has been written
+    std::atomic<bool> finished{false};
+    Move bestMove;
+};
+
+#endif // ENGINE_PLAYER_H
@@ -0,0 +1,292 @@
+#include "fen.h"
+
+namespace {
+
+// Indexed by PieceType
+const char PieceChars[6] = { 'k', 'q', 'b', 'n', 'r', 'p' };
+
+// Piece codes by FEN letter, NoPiece for anything else; a lookup instead of a switch per square
+struct PieceTable {
+    Piece codes[256];
+    PieceTable() {
+        for (Piece& code : codes) code = NoPiece;
+        for (int type = 0; type < 6; ++type) {
+            PieceType pieceType = static_cast<PieceType>(type);
+            codes[static_cast<unsigned char>(PieceChars[type] - 0x20)] = makePiece(pieceType, PieceColour::White);
+            codes[static_cast<unsigned char>(PieceChars[type])] = makePiece(pieceType, PieceColour::Black);
+        }
+    }
+};
+
+const PieceTable PieceCodes;
+
+// Counters beyond this are rejected rather than overflowing
+constexpr int MaxCounter = 1000000;
+
+// Walks a FEN one space-separated field at a time
+class FenReader {
+public:
+    explicit FenReader(std::string_view text) : text(text), pos(0) {}
+
+    bool atEnd() {
+        skipSpaces();
+        return pos == text.size();
+    }
+
+    // The next field, or an empty view at the end of the text
+    std::string_view field() {
+        skipSpaces();
+        size_t start = pos;
+        while (pos < text.size() && text[pos] != ' ' && text[pos] != '\t') ++pos;
+        fieldStart = start;
+        return text.substr(start, pos - start);
+    }
+
+    // Offset of the last field returned, for error reports
+    size_t offset() const { return fieldStart; }
+
+private:
+    std::string_view text;
+    size_t pos;
+    size_t fieldStart = 0;
+
+    void skipSpaces() {
+        while (pos < text.size() && (text[pos] == ' ' || text[pos] == '\t')) ++pos;
+    }
+};
+
+bool fail(FenError* error, const char* message, size_t offset) {
+    if (error) {
+        error->message = message;
+        error->offset = offset;
+    }
+    return false;
+}
+
+// Parses a decimal counter; false if the field is not a number or is out of range
+bool parseCounter(std::string_view field, int& value) {
+    if (field.empty()) return false;
+    value = 0;
+    for (char c : field) {
+        if (c < '0' || c > '9') return false;
+        value = value * 10 + (c - '0');
+        if (value > MaxCounter) return false;
+    }
+    return true;
+}
+
+// Whether a piece of colour by attacks square on a board that is not in a Position yet
+bool isAttacked(const Piece board[64], int square, PieceColour by) {
+    Bitboard occupied = 0;
+    Bitboard pieces[6] = {};
+    for (int s = 0; s < 64; ++s) {
+        if (board[s] == NoPiece) continue;
+        occupied |= squareBB(s);
+        if (colourOf(board[s]) == by) pieces[static_cast<int>(typeOf(board[s]))] |= squareBB(s);
+    }
+    Bitboard queens = pieces[static_cast<int>(PieceType::Queen)];
+    return (pawnAttacks(opposite(by), square) & pieces[static_cast<int>(PieceType::Pawn)])
+        || (knightAttacks(square) & pieces[static_cast<int>(PieceType::Knight)])
+        || (kingAttacks(square) & pieces[static_cast<int>(PieceType::King)])
+        || (bishopAttacks(square, occupied) & (pieces[static_cast<int>(PieceType::Bishop)] | queens))
+        || (rookAttacks(square, occupied) & (pieces[static_cast<int>(PieceType::Rook)] | queens));
+}
+
+char* writeNumber(char* out, int value) {
+    char digits[12];
+    int count = 0;
+    do {
+        digits[count++] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value > 0);
+    while (count > 0) *out++ = digits[--count];
+    return out;
+}
+
+} // namespace
+
+bool parseFen(std::string_view fen, Position& position, FenError* error) {
+    FenReader reader(fen);
+
+    // Everything is checked before the position is touched
+    Piece board[64];
+    for (Piece& piece : board) piece = NoPiece;
+    int kings[2] = { 0, 0 };
+    int kingSquares[2] = { NoSquare, NoSquare };
+
+    std::string_view placement = reader.field();
+    size_t base = reader.offset();
+    if (placement.empty()) return fail(error, "empty FEN", 0);
+    int rank = 7;
+    int file = 0;
+    for (size_t i = 0; i < placement.size(); ++i) {
+        char c = placement[i];
+        if (c == '/') {
+            if (file != 8) return fail(error, "rank does not have 8 squares", base + i);
+            if (rank == 0) return fail(error, "more than 8 ranks", base + i);
+            rank--;
+            file = 0;
+        } else if (c >= '1' && c <= '8') {
+            file += c - '0';
+            if (file > 8) return fail(error, "rank has more than 8 squares", base + i);
+        } else if (c == '0' || c == '9') {
+            return fail(error, "empty square count must be 1-8", base + i);
+        } else {
+            Piece piece = PieceCodes.codes[static_cast<unsigned char>(c)];
+            if (piece == NoPiece) return fail(error, "unknown piece letter", base + i);
+            if (file == 8) return fail(error, "rank has more than 8 squares", base + i);
+            PieceType type = typeOf(piece);
+            if (type == PieceType::Pawn && (rank == 0 || rank == 7)) {
+                return fail(error, "pawn on the first or last rank", base + i);
+            }
+            if (type == PieceType::King) {
+                kings[static_cast<int>(colourOf(piece))]++;
+                kingSquares[static_cast<int>(colourOf(piece))] = makeSquare(file, rank);
+            }
+            board[makeSquare(file, rank)] = piece;
+            file++;
+        }
+    }
+    if (rank != 0 || file != 8) return fail(error, "placement does not cover 8 ranks of 8 squares", base);
+    if (kings[0] != 1 || kings[1] != 1) return fail(error, "each side needs exactly one king", base);
+
+    std::string_view side = reader.field();
+    PieceColour sideToMove;
+    if (side == "w") {
+        sideToMove = PieceColour::White;
+    } else if (side == "b") {
+        sideToMove = PieceColour::Black;
+    } else {
+        return fail(error, side.empty() ? "missing side to move" : "side to move must be w or b", reader.offset());
+    }
+    // The side that just moved cannot have left its king to be captured
+    if (isAttacked(board, kingSquares[static_cast<int>(opposite(sideToMove))], sideToMove)) {
+        return fail(error, "side not to move is in check", reader.offset());
+    }
+
+    std::string_view castling = reader.field();
+    if (castling.empty()) return fail(error, "missing castling rights", reader.offset());
+    int rights = 0;
+    if (castling != "-") {
+        for (size_t i = 0; i < castling.size(); ++i) {
+            int right;
+            switch (castling[i]) {
+                case 'K': right = WhiteKingside; break;
+                case 'Q': right = WhiteQueenside; break;
+                case 'k': right = BlackKingside; break;
+                case 'q': right = BlackQueenside; break;
+                default: return fail(error, "castling rights must be - or letters from KQkq", reader.offset() + i);
+            }
+            if (rights & right) return fail(error, "castling right given twice", reader.offset() + i);
+            rights |= right;
+        }
+    }
+    // A right is only usable with the king and rook still on their squares
+    const Piece whiteKing = makePiece(PieceType::King, PieceColour::White);
+    const Piece whiteRook = makePiece(PieceType::Rook, PieceColour::White);
+    const Piece blackKing = makePiece(PieceType::King, PieceColour::Black);
+    const Piece blackRook = makePiece(PieceType::Rook, PieceColour::Black);
+    if (board[4] != whiteKing || board[7] != whiteRook) rights &= ~WhiteKingside;
+    if (board[4] != whiteKing || board[0] != whiteRook) rights &= ~WhiteQueenside;
+    if (board[60] != blackKing || board[63] != blackRook) rights &= ~BlackKingside;
+    if (board[60] != blackKing || board[56] != blackRook) rights &= ~BlackQueenside;
+
+    std::string_view enPassant = reader.field();
+    if (enPassant.empty()) return fail(error, "missing en passant square", reader.offset());
+    int enPassantSquare = NoSquare;
+    if (enPassant != "-") {
+        // The square passed over is on the 6th rank when White is to move, the 3rd when Black is
+        char expectedRank = sideToMove == PieceColour::White ? '6' : '3';
+        if (enPassant.size() != 2 || enPassant[0] < 'a' || enPassant[0] > 'h' || enPassant[1] != expectedRank) {
+            return fail(error, "invalid en passant square", reader.offset());
+        }
+        enPassantSquare = makeSquare(enPassant[0] - 'a', enPassant[1] - '1');
+        // The pawn that just moved two squares stands in front of it, with both squares it left empty
+        int forward = sideToMove == PieceColour::White ? 8 : -8;
+        if (board[enPassantSquare - forward] != makePiece(PieceType::Pawn, opposite(sideToMove))
+            || board[enPassantSquare] != NoPiece || board[enPassantSquare + forward] != NoPiece) {
+            return fail(error, "en passant square without a pawn that just moved two squares", reader.offset());
+        }
+    }
+
+    int halfmove = 0;
+    int fullmove = 1;
+    if (!reader.atEnd()) {
+        if (!parseCounter(reader.field(), halfmove)) return fail(error, "invalid halfmove clock", reader.offset());
+        if (!reader.atEnd()) {
+            if (!parseCounter(reader.field(), fullmove)) return fail(error, "invalid fullmove number", reader.offset());
+            // Some generators write 0 for the first move
+            if (fullmove == 0) fullmove = 1;
+        }
+    }
+    if (!reader.atEnd()) {
+        reader.field();
+        return fail(error, "unexpected text after the fullmove number", reader.offset());
+    }
+
+    position.clear();
+    for (int square = 0; square < 64; ++square) {
+        if (board[square] != NoPiece) position.putPiece(typeOf(board[square]), colourOf(board[square]), square);
+    }
+    position.setSideToMove(sideToMove);
+    position.setCastlingRights(rights);
+    // Kept only if a pawn can take there, as makeMove does
+    if (enPassantSquare != NoSquare
+        && (pawnAttacks(opposite(sideToMove), enPassantSquare) & position.pieces(sideToMove, PieceType::Pawn))) {
+        position.setEnPassantSquare(enPassantSquare);
+    }
+    position.setHalfmoveClock(halfmove);
+    position.setFullmoveNumber(fullmove);
+    return true;
+}
+
+size_t writeFen(const Position& position, char* out) {
+    char* start = out;
+    for (int rank = 7; rank >= 0; --rank) {
+        int empty = 0;
+        for (int file = 0; file < 8; ++file) {
+            Piece piece = position.pieceOn(makeSquare(file, rank));
+            if (piece == NoPiece) {
+                empty++;
+                continue;
+            }
+            if (empty) *out++ = static_cast<char>('0' + empty);
+            empty = 0;
+            char c = PieceChars[static_cast<int>(typeOf(piece))];
+            *out++ = colourOf(piece) == PieceColour::White ? static_cast<char>(c - 0x20) : c;
+        }
+        if (empty) *out++ = static_cast<char>('0' + empty);
+        if (rank > 0) *out++ = '/';
+    }
+
+    *out++ = ' ';
+    *out++ = position.getSideToMove() == PieceColour::White ? 'w' : 'b';
+
+    *out++ = ' ';
+    int rights = position.getCastlingRights();
+    if (!rights) *out++ = '-';
+    if (rights & WhiteKingside) *out++ = 'K';
+    if (rights & WhiteQueenside) *out++ = 'Q';
+    if (rights & BlackKingside) *out++ = 'k';
+    if (rights & BlackQueenside) *out++ = 'q';
+
+    *out++ = ' ';
+    int enPassant = position.getEnPassantSquare();
+    if (enPassant == NoSquare) {
+        *out++ = '-';
+    } else {
+        *out++ = static_cast<char>('a' + fileOf(enPassant));
+        *out++ = static_cast<char>('1' + rankOf(enPassant));
+    }
+
+    *out++ = ' ';
+    out = writeNumber(out, position.getHalfmoveClock());
+    *out++ = ' ';
+    out = writeNumber(out, position.getFullmoveNumber());
+    return static_cast<size_t>(out - start);
+}
+
+std::string toFen(const Position& position) {
+    char buffer[MaxFenLength];
+    return std::string(buffer, writeFen(position, buffer));
+}
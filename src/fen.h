@@ -0,0 +1,32 @@
+#ifndef FEN_H
+#define FEN_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include "position.h"
+
+// Longest FEN writeFen can produce, with room to spare
+constexpr size_t MaxFenLength = 128;
+
+// Why a FEN string was rejected and where; the message is a string literal
+struct FenError {
+    const char* message = "";
+    size_t offset = 0;
+};
+
+// Reads all six FEN fields into position. The halfmove and fullmove counters may be left out,
+// as in EPD. Rejects a position where the side not to move is in check, and an en passant
+// square that no double pawn push can have left.
+// Castling rights without the king and rook on their squares are dropped, and so is an en
+// passant square no pawn can capture to, so the key matches the one makeMove produces.
+// On failure the position is left untouched and error, if given, says what is wrong.
+// Does not allocate.
+bool parseFen(std::string_view fen, Position& position, FenError* error = nullptr);
+
+// Writes the FEN of position to out, which must hold MaxFenLength chars, and returns its length.
+// Not null-terminated.
+size_t writeFen(const Position& position, char* out);
+std::string toFen(const Position& position);
+
+#endif // FEN_H
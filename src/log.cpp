@@ -0,0 +1,84 @@
+#include "log.h"
+#include <atomic>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+
+namespace {
+
+const char* levelName(LogLevel level) {
+    switch (level) {
+        case LogLevel::Error: return "error";
+        case LogLevel::Warning: return "warning";
+        case LogLevel::Info: return "info";
+        case LogLevel::Debug: return "debug";
+    }
+    return "";
+}
+
+// Path components before the file name only make the lines longer
+const char* baseName(const char* path) {
+    const char* slash = std::strrchr(path, '/');
+    const char* backslash = std::strrchr(path, '\\');
+    if (backslash > slash) slash = backslash;
+    return slash ? slash + 1 : path;
+}
+
+std::mutex logMutex;
+
+// A power of two, so the write position wraps with a mask
+constexpr size_t TraceCapacity = 4096;
+constexpr size_t TraceLineLength = 120;
+
+struct TraceEntry {
+    // Number of the line held plus one; 0 while empty or being written
+    std::atomic<uint64_t> sequence{0};
+    int thread = 0;
+    char text[TraceLineLength];
+};
+
+TraceEntry traceRing[TraceCapacity];
+std::atomic<uint64_t> traceNext{0};
+// Hands out the thread numbers shown in the dump
+std::atomic<int> traceThreads{0};
+
+} // namespace
+
+void writeLog(LogLevel level, const char* file, int line, const std::string& message) {
+    std::lock_guard<std::mutex> lock(logMutex);
+    std::cerr << '[' << levelName(level) << "] " << baseName(file) << ':' << line << ' ' << message << '\n';
+}
+
+#ifdef CHESS_TRACE_ENABLED
+void trace(const char* format, ...) {
+    uint64_t sequence = traceNext.fetch_add(1, std::memory_order_relaxed);
+    TraceEntry& entry = traceRing[sequence & (TraceCapacity - 1)];
+    entry.sequence.store(0, std::memory_order_relaxed);
+    thread_local int thread = traceThreads.fetch_add(1, std::memory_order_relaxed);
+    entry.thread = thread;
+    va_list args;
+    va_start(args, format);
+    std::vsnprintf(entry.text, TraceLineLength, format, args);
+    va_end(args);
+    entry.sequence.store(sequence + 1, std::memory_order_release);
+}
+#endif
+
+void dumpTrace(std::ostream& out) {
+    uint64_t end = traceNext.load(std::memory_order_acquire);
+    uint64_t begin = end > TraceCapacity ? end - TraceCapacity : 0;
+    for (uint64_t sequence = begin; sequence < end; ++sequence) {
+        const TraceEntry& entry = traceRing[sequence & (TraceCapacity - 1)];
+        // Skip lines already overwritten by a newer one or still being written
+        if (entry.sequence.load(std::memory_order_acquire) != sequence + 1) continue;
+        out << '#' << entry.thread << ' ' << entry.text << '\n';
+    }
+}
+
+void clearTrace() {
+    for (TraceEntry& entry : traceRing) entry.sequence.store(0, std::memory_order_relaxed);
+    traceNext.store(0, std::memory_order_release);
+}
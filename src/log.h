@@ -0,0 +1,65 @@
+#ifndef LOG_H
+#define LOG_H
+
+#include <ostream>
+#include <sstream>
+#include <string>
+
+// Compile-time log levels. A message above CHESS_LOG_LEVEL is discarded by the compiler along
+// with its arguments, so logging left in hot code costs nothing in a release build. Messages go
+// to stderr, which keeps stdout clean for the UCI protocol.
+#define CHESS_LOG_LEVEL_OFF 0
+#define CHESS_LOG_LEVEL_ERROR 1
+#define CHESS_LOG_LEVEL_WARNING 2
+#define CHESS_LOG_LEVEL_INFO 3
+#define CHESS_LOG_LEVEL_DEBUG 4
+
+// Set by the build (cmake -DCHESS_LOG_LEVEL=...); otherwise warnings and errors only in release
+#ifndef CHESS_LOG_LEVEL
+#ifdef NDEBUG
+#define CHESS_LOG_LEVEL CHESS_LOG_LEVEL_WARNING
+#else
+#define CHESS_LOG_LEVEL CHESS_LOG_LEVEL_DEBUG
+#endif
+#endif
+
+enum class LogLevel { Error = 1, Warning, Info, Debug };
+
+void writeLog(LogLevel level, const char* file, int line, const std::string& message);
+
+// message is anything that can be streamed: CHESS_LOG_DEBUG("move " << move.toString())
+#define CHESS_LOG(level, message)                                       \
+    do {                                                                \
+        if constexpr (static_cast<int>(level) <= CHESS_LOG_LEVEL) {     \
+            std::ostringstream chessLogStream;                          \
+            chessLogStream << message;                                  \
+            writeLog(level, __FILE__, __LINE__, chessLogStream.str());  \
+        }                                                               \
+    } while (0)
+
+#define CHESS_LOG_ERROR(message) CHESS_LOG(LogLevel::Error, message)
+#define CHESS_LOG_WARNING(message) CHESS_LOG(LogLevel::Warning, message)
+#define CHESS_LOG_INFO(message) CHESS_LOG(LogLevel::Info, message)
+#define CHESS_LOG_DEBUG(message) CHESS_LOG(LogLevel::Debug, message)
+
+// Ring-buffer trace for debugging a particular search. CHESS_TRACE records a printf-style line
+// in memory without locking or allocating, and dumpTrace prints the most recent lines, tagged
+// with the thread that wrote them. Only compiled in with CHESS_TRACE_ENABLED
+// (cmake -DCHESS_TRACE=ON); otherwise the arguments are not even evaluated.
+#ifdef CHESS_TRACE_ENABLED
+constexpr bool TraceEnabled = true;
+#if defined(__GNUC__)
+__attribute__((format(printf, 1, 2)))
+#endif
+void trace(const char* format, ...);
+#define CHESS_TRACE(...) trace(__VA_ARGS__)
+#else
+constexpr bool TraceEnabled = false;
+#define CHESS_TRACE(...) do {} while (0)
+#endif
+
+// Oldest first. Lines written while dumping may come out garbled, so dump between searches.
+void dumpTrace(std::ostream& out);
+void clearTrace();
+
+#endif // LOG_H
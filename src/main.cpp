@@ -1,6 +1,15 @@
 #include <SFML/Graphics.hpp>
 #include "board.h"
-#include "piece.h"
+#include "engine_player.h"
+
+namespace {
+
+// Thinking time per engine move
+constexpr int EngineMoveTime = 1000;
+// How often the window looks for the engine's move while it thinks
+const sf::Time EnginePollInterval = sf::milliseconds(15);
+
+} // namespace
 
 int main() {
     sf::RenderWindow window(sf::VideoMode(800, 800), "Chessboard");
@@ -32,22 +41,60 @@ int main() {
     // std::string initialFEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR";
     // board.initializeBoard();
 
+    EnginePlayer engine(EngineMoveTime);
+    // The side the engine plays, picked with E; None while two people play
+    PieceColour engineColour = PieceColour::None;
+    // Set whenever the window content is out of date; nothing is drawn otherwise
+    bool dirty = true;
+
     while (window.isOpen()) {
+        // Sleep in waitEvent until something happens. While the engine thinks its move has to
+        // be picked up too, which waitEvent cannot wake for, so poll instead.
         sf::Event event;
-        while (window.pollEvent(event)) {
+        bool hasEvent = engine.isThinking() ? window.pollEvent(event) : window.waitEvent(event);
+        while (hasEvent) {
             if (event.type == sf::Event::Closed)
                 window.close();
             if (event.type == sf::Event::MouseButtonPressed) {
-                if (event.mouseButton.button == sf::Mouse::Left) {
+                // The board is the engine's while it thinks
+                if (event.mouseButton.button == sf::Mouse::Left && !engine.isThinking()) {
                     board.handleEvent(event, window);
+                    dirty = true;
+                }
+            }
+            if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::E) {
+                // Hand the side to move to the engine, or take it back
+                if (engineColour == PieceColour::None) {
+                    engineColour = board.getSideToMove();
+                } else {
+                    engineColour = PieceColour::None;
+                    engine.cancel();
                 }
             }
+            if (event.type == sf::Event::Resized || event.type == sf::Event::GainedFocus)
+                dirty = true;
+            hasEvent = window.pollEvent(event);
         }
+        if (!window.isOpen()) break;
 
-        window.clear();
-        board.draw(window);
-        window.display();
+        Move move;
+        if (engine.takeMove(move)) {
+            board.playMove(move);
+            dirty = true;
+        }
+        if (engineColour == board.getSideToMove() && !board.isGameOver() && !engine.isThinking()) {
+            engine.start(board.getStartFen(), board.getMoves());
+        }
+
+        if (dirty) {
+            window.clear();
+            board.draw(window);
+            window.display();
+            dirty = false;
+        } else if (engine.isThinking()) {
+            sf::sleep(EnginePollInterval);
+        }
     }
 
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,37 @@
+#include "move.h"
+
+int Move::promotionIndex(PieceType type) {
+    switch (type) {
+        case PieceType::Bishop: return 1;
+        case PieceType::Rook: return 2;
+        case PieceType::Queen: return 3;
+        default: return 0;
+    }
+}
+
+PieceType Move::promotion() const {
+    static const PieceType types[4] = { PieceType::Knight, PieceType::Bishop, PieceType::Rook, PieceType::Queen };
+    return types[(data >> 12) & 3];
+}
+
+std::string Move::toString() const {
+    if (isNone()) return "0000";
+
+    std::string result;
+    result += static_cast<char>('a' + fileOf(from()));
+    result += static_cast<char>('1' + rankOf(from()));
+    result += static_cast<char>('a' + fileOf(to()));
+    result += static_cast<char>('1' + rankOf(to()));
+    if (kind() == MoveKind::Promotion) {
+        static const char promotionChars[4] = { 'n', 'b', 'r', 'q' };
+        result += promotionChars[(data >> 12) & 3];
+    }
+    return result;
+}
+
+bool MoveList::contains(Move move) const {
+    for (int i = 0; i < count; ++i) {
+        if (moves[i] == move) return true;
+    }
+    return false;
+}
@@ -0,0 +1,72 @@
+#ifndef MOVE_H
+#define MOVE_H
+
+#include <cstdint>
+#include <string>
+#include "types.h"
+
+enum class MoveKind
+{
+    Normal,
+    Promotion,
+    EnPassant,
+    Castling
+};
+
+// A move packed into 16 bits:
+// bits 0-5 from square, bits 6-11 to square, bits 12-13 promotion piece, bits 14-15 move kind.
+// Castling is encoded as the king's two-square step (e1g1, e1c1, ...).
+class Move {
+public:
+    Move() = default;
+    Move(int from, int to, MoveKind kind = MoveKind::Normal, PieceType promotion = PieceType::Knight)
+        : data(static_cast<uint16_t>(from | (to << 6) | (promotionIndex(promotion) << 12) | (static_cast<int>(kind) << 14))) {}
+
+    static Move none() { return fromRaw(0); }
+    static Move fromRaw(uint16_t raw) { Move m; m.data = raw; return m; }
+
+    int from() const { return data & 0x3F; }
+    int to() const { return (data >> 6) & 0x3F; }
+    MoveKind kind() const { return static_cast<MoveKind>(data >> 14); }
+    PieceType promotion() const;
+    uint16_t raw() const { return data; }
+    bool isNone() const { return data == 0; }
+
+    bool operator==(Move other) const { return data == other.data; }
+    bool operator!=(Move other) const { return data != other.data; }
+
+    // Long algebraic notation as used by UCI, e.g. "e2e4" or "e7e8q"
+    std::string toString() const;
+
+private:
+    uint16_t data;
+
+    static int promotionIndex(PieceType type);
+};
+
+constexpr int MaxMoves = 256;
+
+// Fixed-capacity move list that lives on the stack so move generation never allocates
+class MoveList {
+public:
+    MoveList() : count(0) {}
+
+    void add(Move move) { moves[count++] = move; }
+    void clear() { count = 0; }
+    int size() const { return count; }
+    bool empty() const { return count == 0; }
+    bool contains(Move move) const;
+
+    Move& operator[](int index) { return moves[index]; }
+    Move operator[](int index) const { return moves[index]; }
+    Move* begin() { return moves; }
+    Move* end() { return moves + count; }
+    const Move* begin() const { return moves; }
+    const Move* end() const { return moves + count; }
+
+private:
+    Move moves[MaxMoves];
+    int count;
+};
+
+#endif // MOVE_H
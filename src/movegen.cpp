@@ -0,0 +1,309 @@
+#include "movegen.h"
+
+namespace {
+
+void addMoves(int from, Bitboard targets, MoveList& moves) {
+    while (targets) {
+        moves.add(Move(from, popLsb(targets)));
+    }
+}
+
+void addPawnMove(int from, int to, MoveList& moves) {
+    if (rankOf(to) == 0 || rankOf(to) == 7) {
+        moves.add(Move(from, to, MoveKind::Promotion, PieceType::Queen));
+        moves.add(Move(from, to, MoveKind::Promotion, PieceType::Rook));
+        moves.add(Move(from, to, MoveKind::Promotion, PieceType::Bishop));
+        moves.add(Move(from, to, MoveKind::Promotion, PieceType::Knight));
+    } else {
+        moves.add(Move(from, to));
+    }
+}
+
+// Only destinations inside targets are kept; the legal generator narrows them to the
+// check and pin masks, the pseudo-legal one passes every square.
+// Promotions count as captures, so a picker sees them with the other forcing moves.
+void addPawnMoves(const Position& position, int from, Bitboard targets, GenType type, MoveList& moves) {
+    PieceColour colour = position.colourOn(from);
+    int direction = colour == PieceColour::White ? 8 : -8;
+    int startRank = colour == PieceColour::White ? 1 : 6;
+    int lastRank = colour == PieceColour::White ? 7 : 0;
+    if (rankOf(from) == lastRank) return;
+
+    // Move forward one square, and two from the starting rank
+    int oneStep = from + direction;
+    bool promotion = rankOf(oneStep) == lastRank;
+    if (position.isEmpty(oneStep)) {
+        if ((targets & squareBB(oneStep)) && (promotion ? type != GenType::Quiets : type != GenType::Captures)) {
+            addPawnMove(from, oneStep, moves);
+        }
+        int twoSteps = oneStep + direction;
+        if (type != GenType::Captures && rankOf(from) == startRank && position.isEmpty(twoSteps)
+            && (targets & squareBB(twoSteps))) {
+            moves.add(Move(from, twoSteps));
+        }
+    }
+
+    // Diagonal captures; en passant is handled by the callers
+    if (type == GenType::Quiets) return;
+    Bitboard captures = pawnAttacks(colour, from) & position.pieces(opposite(colour)) & targets;
+    while (captures) {
+        addPawnMove(from, popLsb(captures), moves);
+    }
+}
+
+void addCastlingMoves(const Position& position, int from, MoveList& moves) {
+    PieceColour colour = position.colourOn(from);
+    PieceColour enemy = opposite(colour);
+    int rights = position.getCastlingRights();
+    int kingside = colour == PieceColour::White ? WhiteKingside : BlackKingside;
+    int queenside = colour == PieceColour::White ? WhiteQueenside : BlackQueenside;
+    int backRank = colour == PieceColour::White ? 0 : 7;
+
+    if (!(rights & (kingside | queenside))) return;
+    if (from != makeSquare(4, backRank) || isSquareAttacked(position, from, enemy)) return;
+
+    if ((rights & kingside)
+        && position.isEmpty(makeSquare(5, backRank)) && position.isEmpty(makeSquare(6, backRank))
+        && !isSquareAttacked(position, makeSquare(5, backRank), enemy)
+        && !isSquareAttacked(position, makeSquare(6, backRank), enemy)) {
+        moves.add(Move(from, makeSquare(6, backRank), MoveKind::Castling));
+    }
+    if ((rights & queenside)
+        && position.isEmpty(makeSquare(1, backRank)) && position.isEmpty(makeSquare(2, backRank))
+        && position.isEmpty(makeSquare(3, backRank))
+        && !isSquareAttacked(position, makeSquare(2, backRank), enemy)
+        && !isSquareAttacked(position, makeSquare(3, backRank), enemy)) {
+        moves.add(Move(from, makeSquare(2, backRank), MoveKind::Castling));
+    }
+}
+
+} // namespace
+
+void generatePieceMoves(const Position& position, int square, MoveList& moves) {
+    Piece piece = position.pieceOn(square);
+    if (piece == NoPiece) return;
+    PieceColour colour = colourOf(piece);
+    Bitboard occupied = position.occupied();
+    Bitboard notOwn = ~position.pieces(colour);
+    switch (typeOf(piece)) {
+        case PieceType::Pawn: {
+            addPawnMoves(position, square, ~Bitboard(0), GenType::All, moves);
+            int enPassant = position.getEnPassantSquare();
+            if (enPassant != NoSquare && (pawnAttacks(colour, square) & squareBB(enPassant))) {
+                moves.add(Move(square, enPassant, MoveKind::EnPassant));
+            }
+            break;
+        }
+        case PieceType::Knight: addMoves(square, knightAttacks(square) & notOwn, moves); break;
+        case PieceType::Bishop: addMoves(square, bishopAttacks(square, occupied) & notOwn, moves); break;
+        case PieceType::Rook: addMoves(square, rookAttacks(square, occupied) & notOwn, moves); break;
+        case PieceType::Queen: addMoves(square, queenAttacks(square, occupied) & notOwn, moves); break;
+        case PieceType::King:
+            addMoves(square, kingAttacks(square) & notOwn, moves);
+            addCastlingMoves(position, square, moves);
+            break;
+        default: break;
+    }
+}
+
+void generatePseudoLegalMoves(const Position& position, MoveList& moves) {
+    Bitboard own = position.pieces(position.getSideToMove());
+    while (own) {
+        generatePieceMoves(position, popLsb(own), moves);
+    }
+}
+
+void generateLegalMoves(const Position& position, MoveList& moves, GenType type) {
+    PieceColour us = position.getSideToMove();
+    PieceColour them = opposite(us);
+    int king = position.kingSquare(us);
+    Bitboard own = position.pieces(us);
+    Bitboard occupied = position.occupied();
+    Bitboard theirQueens = position.pieces(them, PieceType::Queen);
+    Bitboard theirRooks = position.pieces(them, PieceType::Rook) | theirQueens;
+    Bitboard theirBishops = position.pieces(them, PieceType::Bishop) | theirQueens;
+
+    // The king steps are tested with the king lifted off the board, so it cannot hide
+    // from a slider behind its own square
+    Bitboard withoutKing = occupied ^ squareBB(king);
+    Bitboard stageTargets = type == GenType::Captures ? position.pieces(them)
+                          : type == GenType::Quiets ? ~occupied : ~own;
+    Bitboard kingTargets = kingAttacks(king) & stageTargets;
+    while (kingTargets) {
+        int to = popLsb(kingTargets);
+        if (!isSquareAttacked(position, to, them, withoutKing)) moves.add(Move(king, to));
+    }
+
+    Bitboard checkers = position.checkers();
+    // In double check only the king can move
+    if (popcount(checkers) > 1) return;
+
+    // Every other move has to capture the checker or block its ray
+    Bitboard checkMask = checkers ? between(king, lsb(checkers)) | checkers : ~Bitboard(0);
+
+    // A piece is pinned if it is the only one between our king and an enemy slider on the same line
+    Bitboard pinned = 0;
+    Bitboard snipers = (rookAttacks(king, 0) & theirRooks) | (bishopAttacks(king, 0) & theirBishops);
+    while (snipers) {
+        Bitboard blockers = between(king, popLsb(snipers)) & occupied;
+        if (popcount(blockers) == 1) pinned |= blockers & own;
+    }
+
+    Bitboard pieces = own & ~squareBB(king);
+    while (pieces) {
+        int from = popLsb(pieces);
+        // Pinned pieces may only slide along the pin
+        Bitboard targets = ~own & checkMask;
+        if (pinned & squareBB(from)) targets &= line(king, from);
+
+        switch (position.typeOn(from)) {
+            case PieceType::Pawn: addPawnMoves(position, from, targets, type, moves); break;
+            case PieceType::Knight: addMoves(from, knightAttacks(from) & targets & stageTargets, moves); break;
+            case PieceType::Bishop: addMoves(from, bishopAttacks(from, occupied) & targets & stageTargets, moves); break;
+            case PieceType::Rook: addMoves(from, rookAttacks(from, occupied) & targets & stageTargets, moves); break;
+            case PieceType::Queen: addMoves(from, queenAttacks(from, occupied) & targets & stageTargets, moves); break;
+            default: break;
+        }
+    }
+
+    // En passant removes two pieces from one rank, which no pin mask describes, so test
+    // the resulting occupancy against the enemy sliders directly
+    int enPassant = position.getEnPassantSquare();
+    if (enPassant != NoSquare && type != GenType::Quiets) {
+        int captured = enPassant + (us == PieceColour::White ? -8 : 8);
+        Bitboard capturers = pawnAttacks(them, enPassant) & position.pieces(us, PieceType::Pawn);
+        if (checkMask & (squareBB(enPassant) | squareBB(captured))) {
+            while (capturers) {
+                int from = popLsb(capturers);
+                Bitboard after = (occupied ^ squareBB(from) ^ squareBB(captured)) | squareBB(enPassant);
+                if (!(rookAttacks(king, after) & theirRooks)
+                    && !(bishopAttacks(king, after) & theirBishops)) {
+                    moves.add(Move(from, enPassant, MoveKind::EnPassant));
+                }
+            }
+        }
+    }
+
+    if (!checkers && type != GenType::Captures) addCastlingMoves(position, king, moves);
+}
+
+bool isPseudoLegal(const Position& position, Move move) {
+    if (move.isNone()) return false;
+    PieceColour us = position.getSideToMove();
+    int from = move.from();
+    int to = move.to();
+    // Only promotions may carry a promotion piece; anything else is a corrupted move
+    if (move.kind() != MoveKind::Promotion && move != Move(from, to, move.kind())) return false;
+    if (!(position.pieces(us) & squareBB(from)) || (position.pieces(us) & squareBB(to))) return false;
+
+    PieceType type = position.typeOn(from);
+    Bitboard occupied = position.occupied();
+    switch (move.kind()) {
+        case MoveKind::Castling: {
+            if (type != PieceType::King) return false;
+            MoveList castling;
+            addCastlingMoves(position, from, castling);
+            return castling.contains(move);
+        }
+        case MoveKind::EnPassant:
+            return type == PieceType::Pawn && to == position.getEnPassantSquare()
+                && (pawnAttacks(us, from) & squareBB(to));
+        default:
+            break;
+    }
+
+    if (type != PieceType::Pawn) {
+        if (move.kind() == MoveKind::Promotion) return false;
+        switch (type) {
+            case PieceType::Knight: return knightAttacks(from) & squareBB(to);
+            case PieceType::Bishop: return bishopAttacks(from, occupied) & squareBB(to);
+            case PieceType::Rook: return rookAttacks(from, occupied) & squareBB(to);
+            case PieceType::Queen: return queenAttacks(from, occupied) & squareBB(to);
+            case PieceType::King: return kingAttacks(from) & squareBB(to);
+            default: return false;
+        }
+    }
+
+    // Pawns promote exactly when they reach the last rank
+    int direction = us == PieceColour::White ? 8 : -8;
+    int lastRank = us == PieceColour::White ? 7 : 0;
+    if ((rankOf(to) == lastRank) != (move.kind() == MoveKind::Promotion)) return false;
+    if (pawnAttacks(us, from) & position.pieces(opposite(us)) & squareBB(to)) return true;
+    if (to == from + direction) return position.isEmpty(to);
+    int startRank = us == PieceColour::White ? 1 : 6;
+    return to == from + 2 * direction && rankOf(from) == startRank
+        && position.isEmpty(from + direction) && position.isEmpty(to);
+}
+
+bool isQuiet(const Position& position, Move move) {
+    return position.isEmpty(move.to()) && move.kind() != MoveKind::EnPassant && move.kind() != MoveKind::Promotion;
+}
+
+bool givesCheck(const Position& position, Move move) {
+    PieceColour us = position.getSideToMove();
+    int king = position.kingSquare(opposite(us));
+    int from = move.from();
+    int to = move.to();
+    PieceType type = move.kind() == MoveKind::Promotion ? move.promotion() : position.typeOn(from);
+
+    // The board after the move; the moving piece is only counted on its new square
+    Bitboard occupied = (position.occupied() ^ squareBB(from)) | squareBB(to);
+    Bitboard queens = position.pieces(us, PieceType::Queen);
+    Bitboard diagonal = (position.pieces(us, PieceType::Bishop) | queens) & ~squareBB(from);
+    Bitboard straight = (position.pieces(us, PieceType::Rook) | queens) & ~squareBB(from);
+    if (move.kind() == MoveKind::EnPassant) {
+        occupied ^= squareBB(us == PieceColour::White ? to - 8 : to + 8);
+    } else if (move.kind() == MoveKind::Castling) {
+        bool kingside = to > from;
+        int rookFrom = kingside ? to + 1 : to - 2;
+        int rookTo = kingside ? to - 1 : to + 1;
+        occupied = (occupied ^ squareBB(rookFrom)) | squareBB(rookTo);
+        straight = (straight & ~squareBB(rookFrom)) | squareBB(rookTo);
+    }
+
+    Bitboard attacks = 0;
+    switch (type) {
+        case PieceType::Pawn: attacks = pawnAttacks(us, to); break;
+        case PieceType::Knight: attacks = knightAttacks(to); break;
+        case PieceType::Bishop: attacks = bishopAttacks(to, occupied); break;
+        case PieceType::Rook: attacks = rookAttacks(to, occupied); break;
+        case PieceType::Queen: attacks = queenAttacks(to, occupied); break;
+        default: break; // A king cannot check, only uncover a check
+    }
+    if (attacks & squareBB(king)) return true;
+    // Discovered checks, and the rook's check after castling
+    return (bishopAttacks(king, occupied) & diagonal) || (rookAttacks(king, occupied) & straight);
+}
+
+bool isLegal(const Position& position, Move move) {
+    PieceColour us = position.getSideToMove();
+    Bitboard enemies = position.pieces(opposite(us));
+    int from = move.from();
+    int to = move.to();
+
+    // Castling is only generated when the king's path is safe
+    if (move.kind() == MoveKind::Castling) return true;
+
+    Bitboard occupied = position.occupied() ^ squareBB(from);
+    if (position.typeOn(from) == PieceType::King) {
+        return !(position.attackersTo(to, occupied) & enemies);
+    }
+
+    // Look at the board as it stands after the move: anything captured no longer attacks
+    Bitboard captured = squareBB(to);
+    if (move.kind() == MoveKind::EnPassant) {
+        int capturedSquare = us == PieceColour::White ? to - 8 : to + 8;
+        captured = squareBB(capturedSquare);
+        occupied ^= captured;
+    }
+    occupied |= squareBB(to);
+    return !(position.attackersTo(position.kingSquare(us), occupied) & enemies & ~captured);
+}
+
+bool isSquareAttacked(const Position& position, int square, PieceColour byColour) {
+    return isSquareAttacked(position, square, byColour, position.occupied());
+}
+
+bool isSquareAttacked(const Position& position, int square, PieceColour byColour, Bitboard occupied) {
+    return position.attackersTo(square, occupied) & position.pieces(byColour);
+}
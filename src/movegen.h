@@ -0,0 +1,37 @@
+#ifndef MOVEGEN_H
+#define MOVEGEN_H
+
+#include "move.h"
+#include "position.h"
+
+// Pseudo-legal generation: the moves follow the piece movement rules but may leave
+// the mover's own king in check, so callers still have to filter them.
+void generatePieceMoves(const Position& position, int square, MoveList& moves);
+void generatePseudoLegalMoves(const Position& position, MoveList& moves);
+
+// Which moves a generator call produces. Captures also covers en passant and every
+// promotion; Quiets is everything else, castling included.
+enum class GenType {
+    Captures,
+    Quiets,
+    All
+};
+
+// Legal generation straight from the checkers, pins and check mask; nothing needs to be
+// made and taken back to filter the result
+void generateLegalMoves(const Position& position, MoveList& moves, GenType type = GenType::All);
+
+// Validates a move from outside the generator, e.g. a hash or killer move that may belong to
+// another position. isLegal expects a move that passed isPseudoLegal.
+bool isPseudoLegal(const Position& position, Move move);
+bool isLegal(const Position& position, Move move);
+// Neither a capture nor a promotion, i.e. a move the Quiets stage would generate
+bool isQuiet(const Position& position, Move move);
+// Whether a legal move checks the opponent, directly or by discovery, without making it
+bool givesCheck(const Position& position, Move move);
+
+bool isSquareAttacked(const Position& position, int square, PieceColour byColour);
+// As above, with the given occupancy in place of the position's own
+bool isSquareAttacked(const Position& position, int square, PieceColour byColour, Bitboard occupied);
+
+#endif // MOVEGEN_H
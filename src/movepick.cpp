@@ -0,0 +1,149 @@
+#include "movepick.h"
+#include "movegen.h"
+#include "see.h"
+#include "stats.h"
+#include <cstdlib>
+#include <utility>
+
+namespace {
+
+// Ordering values only; indexed by PieceType, with None for an empty square
+const int MvvLvaValue[7] = { 6, 5, 3, 2, 4, 1, 0 };
+
+} // namespace
+
+void HistoryTable::clear() {
+    for (int c = 0; c < 2; ++c) {
+        for (int from = 0; from < 64; ++from) {
+            for (int to = 0; to < 64; ++to) {
+                scores[c][from][to] = 0;
+            }
+        }
+    }
+}
+
+void HistoryTable::update(PieceColour colour, Move move, int bonus) {
+    int& entry = scores[static_cast<int>(colour)][move.from()][move.to()];
+    // The closer an entry is to the limit, the less a further bonus moves it
+    entry += bonus - entry * std::abs(bonus) / Max;
+}
+
+MovePicker::MovePicker(const Position& position, Move ttMove, const Move killers[2], const HistoryTable& history)
+    : position(position), history(history), ttMove(ttMove), stage(Stage::TTMove), killerIndex(0),
+      capturesOnly(false), current(0) {
+    this->killers[0] = killers[0];
+    this->killers[1] = killers[1];
+}
+
+MovePicker::MovePicker(const Position& position, const HistoryTable& history)
+    : position(position), history(history), ttMove(Move::none()), stage(Stage::GenerateCaptures),
+      killerIndex(0), capturesOnly(!position.inCheck()), current(0) {
+    killers[0] = killers[1] = Move::none();
+}
+
+void MovePicker::scoreCaptures() {
+    for (int i = 0; i < moves.size(); ++i) {
+        Move move = moves[i];
+        // Most valuable victim first, and among those the least valuable attacker
+        PieceType victim = move.kind() == MoveKind::EnPassant ? PieceType::Pawn : position.typeOn(move.to());
+        int score = MvvLvaValue[static_cast<int>(victim)] * 8 - MvvLvaValue[static_cast<int>(position.typeOn(move.from()))];
+        if (move.kind() == MoveKind::Promotion) score += MvvLvaValue[static_cast<int>(move.promotion())] * 8;
+        scores[i] = score;
+    }
+}
+
+void MovePicker::scoreQuiets() {
+    PieceColour us = position.getSideToMove();
+    for (int i = 0; i < moves.size(); ++i) {
+        scores[i] = history.get(us, moves[i]);
+    }
+}
+
+Move MovePicker::pickBest() {
+    int best = current;
+    for (int i = current + 1; i < moves.size(); ++i) {
+        if (scores[i] > scores[best]) best = i;
+    }
+    std::swap(moves[current], moves[best]);
+    std::swap(scores[current], scores[best]);
+    return moves[current++];
+}
+
+Move MovePicker::next() {
+    switch (stage) {
+        case Stage::TTMove:
+            stage = Stage::GenerateCaptures;
+            // A hash move can come from a colliding position, so it is checked before use
+            if (isPseudoLegal(position, ttMove) && isLegal(position, ttMove)) return ttMove;
+            [[fallthrough]];
+
+        case Stage::GenerateCaptures:
+            {
+                CHESS_STAT_TIMER(movegenTime);
+                generateLegalMoves(position, moves, GenType::Captures);
+            }
+            scoreCaptures();
+            current = 0;
+            stage = Stage::Captures;
+            [[fallthrough]];
+
+        case Stage::Captures:
+            while (current < moves.size()) {
+                Move move = pickBest();
+                if (move == ttMove) continue;
+                // Captures that lose material wait until after the quiet moves
+                if (!seeGe(position, move, 0)) {
+                    badCaptures.add(move);
+                    continue;
+                }
+                return move;
+            }
+            // Quiescence search never plays a losing capture, so it is done here
+            if (capturesOnly) {
+                stage = Stage::Done;
+                return Move::none();
+            }
+            stage = Stage::Killers;
+            [[fallthrough]];
+
+        case Stage::Killers:
+            while (killerIndex < 2) {
+                Move killer = killers[killerIndex++];
+                if (killer != ttMove && isPseudoLegal(position, killer) && isQuiet(position, killer)
+                    && isLegal(position, killer)) {
+                    return killer;
+                }
+            }
+            stage = Stage::GenerateQuiets;
+            [[fallthrough]];
+
+        case Stage::GenerateQuiets:
+            moves.clear();
+            {
+                CHESS_STAT_TIMER(movegenTime);
+                generateLegalMoves(position, moves, GenType::Quiets);
+            }
+            scoreQuiets();
+            current = 0;
+            stage = Stage::Quiets;
+            [[fallthrough]];
+
+        case Stage::Quiets:
+            while (current < moves.size()) {
+                Move move = pickBest();
+                if (move != ttMove && move != killers[0] && move != killers[1]) return move;
+            }
+            current = 0;
+            stage = Stage::BadCaptures;
+            [[fallthrough]];
+
+        case Stage::BadCaptures:
+            if (current < badCaptures.size()) return badCaptures[current++];
+            stage = Stage::Done;
+            [[fallthrough]];
+
+        case Stage::Done:
+            break;
+    }
+    return Move::none();
+}
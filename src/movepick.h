@@ -0,0 +1,69 @@
+#ifndef MOVEPICK_H
+#define MOVEPICK_H
+
+#include "move.h"
+#include "position.h"
+
+// Butterfly history: a score per side and from/to pair, raised when a quiet move causes a
+// beta cutoff and lowered when it was searched without one
+class HistoryTable {
+public:
+    static constexpr int Max = 16384;
+
+    HistoryTable() { clear(); }
+    void clear();
+    int get(PieceColour colour, Move move) const {
+        return scores[static_cast<int>(colour)][move.from()][move.to()];
+    }
+    // Positive bonus for a cutoff, negative for a failure; scores saturate towards +-Max
+    void update(PieceColour colour, Move move, int bonus);
+
+private:
+    int scores[2][64][64];
+};
+
+// Hands out the moves of a position best-first in stages: the hash move, winning and even
+// captures by MVV-LVA, the killer moves, the remaining quiet moves by history, and finally the
+// captures that lose material by SEE. Each stage is only generated when the previous one is
+// exhausted, so a cutoff on an early move saves the rest.
+class MovePicker {
+public:
+    MovePicker(const Position& position, Move ttMove, const Move killers[2], const HistoryTable& history);
+    // For quiescence search: only captures and promotions that do not lose material by SEE,
+    // unless in check, when every evasion is needed to tell whether it is mate
+    MovePicker(const Position& position, const HistoryTable& history);
+
+    // The next legal move, or Move::none() once every move has been returned
+    Move next();
+
+private:
+    enum class Stage {
+        TTMove,
+        GenerateCaptures,
+        Captures,
+        Killers,
+        GenerateQuiets,
+        Quiets,
+        BadCaptures,
+        Done
+    };
+
+    const Position& position;
+    const HistoryTable& history;
+    Move ttMove;
+    Move killers[2];
+    Stage stage;
+    int killerIndex;
+    bool capturesOnly;
+    MoveList moves;
+    MoveList badCaptures;
+    int scores[MaxMoves];
+    int current;
+
+    void scoreCaptures();
+    void scoreQuiets();
+    // Swaps the best remaining move to the front and returns it
+    Move pickBest();
+};
+
+#endif // MOVEPICK_H
@@ -0,0 +1,219 @@
+#include "nnue.h"
+#include <fstream>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define NNUE_AVX2
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define NNUE_SSE2
+#endif
+
+namespace {
+
+// Quantisation of the hidden layer and the output weights, and the centipawn scale of the output
+constexpr int QA = 255;
+constexpr int QB = 64;
+constexpr int OutputScale = 400;
+
+// Input order used by the trainer: pawn, knight, bishop, rook, queen, king. Indexed by PieceType.
+const int FeaturePieceIndex[6] = { 5, 4, 2, 1, 3, 0 };
+
+// Each perspective sees its own pieces first and the board from its own side
+int featureIndex(PieceColour perspective, PieceColour colour, PieceType type, int square) {
+    int relativeSquare = perspective == PieceColour::White ? square : square ^ 56;
+    int side = colour == perspective ? 0 : 1;
+    return side * 384 + FeaturePieceIndex[static_cast<int>(type)] * 64 + relativeSquare;
+}
+
+} // namespace
+
+struct Network::Weights {
+    alignas(32) int16_t feature[NnueInputs][NnueHiddenSize];
+    alignas(32) int16_t featureBias[NnueHiddenSize];
+    alignas(32) int16_t output[2 * NnueHiddenSize];
+    int16_t outputBias;
+};
+
+namespace {
+
+// Up to two inputs are switched on and two switched off per perspective by any one move
+struct FeatureDelta {
+    int added[2];
+    int removed[2];
+    int addedCount = 0;
+    int removedCount = 0;
+
+    void add(int index) { added[addedCount++] = index; }
+    void remove(int index) { removed[removedCount++] = index; }
+};
+
+// child = parent + sum of added columns - sum of removed columns, one register width at a time
+void applyDelta(const int16_t (&weights)[NnueInputs][NnueHiddenSize], const int16_t* parent, int16_t* child,
+                const FeatureDelta& delta) {
+#if defined(NNUE_AVX2)
+    for (int i = 0; i < NnueHiddenSize; i += 16) {
+        __m256i sum = _mm256_load_si256(reinterpret_cast<const __m256i*>(parent + i));
+        for (int a = 0; a < delta.addedCount; ++a) {
+            sum = _mm256_add_epi16(sum, _mm256_load_si256(reinterpret_cast<const __m256i*>(&weights[delta.added[a]][i])));
+        }
+        for (int r = 0; r < delta.removedCount; ++r) {
+            sum = _mm256_sub_epi16(sum, _mm256_load_si256(reinterpret_cast<const __m256i*>(&weights[delta.removed[r]][i])));
+        }
+        _mm256_store_si256(reinterpret_cast<__m256i*>(child + i), sum);
+    }
+#elif defined(NNUE_SSE2)
+    for (int i = 0; i < NnueHiddenSize; i += 8) {
+        __m128i sum = _mm_load_si128(reinterpret_cast<const __m128i*>(parent + i));
+        for (int a = 0; a < delta.addedCount; ++a) {
+            sum = _mm_add_epi16(sum, _mm_load_si128(reinterpret_cast<const __m128i*>(&weights[delta.added[a]][i])));
+        }
+        for (int r = 0; r < delta.removedCount; ++r) {
+            sum = _mm_sub_epi16(sum, _mm_load_si128(reinterpret_cast<const __m128i*>(&weights[delta.removed[r]][i])));
+        }
+        _mm_store_si128(reinterpret_cast<__m128i*>(child + i), sum);
+    }
+#else
+    for (int i = 0; i < NnueHiddenSize; ++i) {
+        int sum = parent[i];
+        for (int a = 0; a < delta.addedCount; ++a) sum += weights[delta.added[a]][i];
+        for (int r = 0; r < delta.removedCount; ++r) sum -= weights[delta.removed[r]][i];
+        child[i] = static_cast<int16_t>(sum);
+    }
+#endif
+}
+
+// Dot product of the clipped ReLU of the hidden layer with one half of the output weights
+int32_t clippedDot(const int16_t* hidden, const int16_t* weights) {
+#if defined(NNUE_AVX2)
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i ceiling = _mm256_set1_epi16(QA);
+    __m256i sum = _mm256_setzero_si256();
+    for (int i = 0; i < NnueHiddenSize; i += 16) {
+        __m256i h = _mm256_load_si256(reinterpret_cast<const __m256i*>(hidden + i));
+        h = _mm256_min_epi16(_mm256_max_epi16(h, zero), ceiling);
+        __m256i w = _mm256_load_si256(reinterpret_cast<const __m256i*>(weights + i));
+        sum = _mm256_add_epi32(sum, _mm256_madd_epi16(h, w));
+    }
+    __m128i half = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+    half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0x4E));
+    half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0xB1));
+    return _mm_cvtsi128_si32(half);
+#elif defined(NNUE_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i ceiling = _mm_set1_epi16(QA);
+    __m128i sum = _mm_setzero_si128();
+    for (int i = 0; i < NnueHiddenSize; i += 8) {
+        __m128i h = _mm_load_si128(reinterpret_cast<const __m128i*>(hidden + i));
+        h = _mm_min_epi16(_mm_max_epi16(h, zero), ceiling);
+        __m128i w = _mm_load_si128(reinterpret_cast<const __m128i*>(weights + i));
+        sum = _mm_add_epi32(sum, _mm_madd_epi16(h, w));
+    }
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4E));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xB1));
+    return _mm_cvtsi128_si32(sum);
+#else
+    int32_t sum = 0;
+    for (int i = 0; i < NnueHiddenSize; ++i) {
+        int h = hidden[i] < 0 ? 0 : hidden[i] > QA ? QA : hidden[i];
+        sum += h * weights[i];
+    }
+    return sum;
+#endif
+}
+
+} // namespace
+
+Network::Network() : weights(new Weights()), loaded(false) {
+}
+
+// Out of line so that Weights is a complete type where it is destroyed
+Network::~Network() = default;
+
+bool Network::load(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return false;
+
+    std::unique_ptr<Weights> next(new Weights());
+    file.read(reinterpret_cast<char*>(next->feature), sizeof(next->feature));
+    file.read(reinterpret_cast<char*>(next->featureBias), sizeof(next->featureBias));
+    file.read(reinterpret_cast<char*>(next->output), sizeof(next->output));
+    file.read(reinterpret_cast<char*>(&next->outputBias), sizeof(next->outputBias));
+    if (!file) return false;
+
+    // Anything left over means the file was written for a different architecture
+    file.peek();
+    if (!file.eof()) return false;
+
+    weights = std::move(next);
+    loaded = true;
+    return true;
+}
+
+void Network::refresh(const Position& position, Accumulator& accumulator) const {
+    for (int perspective = 0; perspective < 2; ++perspective) {
+        int16_t* values = accumulator.values[perspective];
+        for (int i = 0; i < NnueHiddenSize; ++i) values[i] = weights->featureBias[i];
+
+        Bitboard occupied = position.occupied();
+        while (occupied) {
+            // Pieces are added two at a time through the same kernel the incremental path uses
+            FeatureDelta delta;
+            for (int n = 0; n < 2 && occupied; ++n) {
+                int square = popLsb(occupied);
+                delta.add(featureIndex(static_cast<PieceColour>(perspective), position.colourOn(square),
+                                       position.typeOn(square), square));
+            }
+            applyDelta(weights->feature, values, values, delta);
+        }
+    }
+}
+
+void Network::update(const Position& position, Move move, const Accumulator& parent, Accumulator& child) const {
+    PieceColour us = position.getSideToMove();
+    PieceColour them = opposite(us);
+    int from = move.from();
+    int to = move.to();
+    PieceType moved = position.typeOn(from);
+
+    for (int perspective = 0; perspective < 2; ++perspective) {
+        PieceColour view = static_cast<PieceColour>(perspective);
+        FeatureDelta delta;
+        delta.remove(featureIndex(view, us, moved, from));
+
+        switch (move.kind()) {
+            case MoveKind::Castling: {
+                // Castling is the king's two-square step; the rook jumps to the square it crossed
+                bool kingside = fileOf(to) == 6;
+                int rookFrom = makeSquare(kingside ? 7 : 0, rankOf(from));
+                int rookTo = makeSquare(kingside ? 5 : 3, rankOf(from));
+                delta.add(featureIndex(view, us, PieceType::King, to));
+                delta.remove(featureIndex(view, us, PieceType::Rook, rookFrom));
+                delta.add(featureIndex(view, us, PieceType::Rook, rookTo));
+                break;
+            }
+            case MoveKind::EnPassant:
+                delta.add(featureIndex(view, us, PieceType::Pawn, to));
+                delta.remove(featureIndex(view, them, PieceType::Pawn, us == PieceColour::White ? to - 8 : to + 8));
+                break;
+            default: {
+                PieceType placed = move.kind() == MoveKind::Promotion ? move.promotion() : moved;
+                delta.add(featureIndex(view, us, placed, to));
+                if (!position.isEmpty(to)) {
+                    delta.remove(featureIndex(view, them, position.typeOn(to), to));
+                }
+                break;
+            }
+        }
+        applyDelta(weights->feature, parent.values[perspective], child.values[perspective], delta);
+    }
+}
+
+int Network::evaluate(const Accumulator& accumulator, PieceColour sideToMove) const {
+    const int16_t* own = accumulator.values[static_cast<int>(sideToMove)];
+    const int16_t* other = accumulator.values[static_cast<int>(opposite(sideToMove))];
+    int64_t output = clippedDot(own, weights->output) + clippedDot(other, weights->output + NnueHiddenSize);
+    // The products and the output bias are both quantised by QA * QB
+    output = (output + weights->outputBias) * OutputScale / (QA * QB);
+    return static_cast<int>(output);
+}
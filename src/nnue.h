@@ -0,0 +1,45 @@
+#ifndef NNUE_H
+#define NNUE_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include "position.h"
+#include "move.h"
+
+// Efficiently updatable neural network: 768 piece-square inputs per perspective, a shared
+// hidden layer of HiddenSize neurons for each side, and one output neuron.
+constexpr int NnueInputs = 768;
+constexpr int NnueHiddenSize = 256;
+
+// First layer sums for both perspectives, indexed by PieceColour.
+// A move only touches a handful of inputs, so a child is its parent plus a few weight columns.
+struct alignas(32) Accumulator {
+    int16_t values[2][NnueHiddenSize];
+};
+
+class Network {
+public:
+    Network();
+    ~Network();
+
+    // Reads a quantised network: feature weights [768][HiddenSize], feature biases [HiddenSize],
+    // output weights [2 * HiddenSize] and one output bias, all little-endian int16.
+    // Returns false and keeps the previous network if the file is missing or the wrong size.
+    bool load(const std::string& path);
+    bool isLoaded() const { return loaded; }
+
+    // Builds both perspectives from scratch
+    void refresh(const Position& position, Accumulator& accumulator) const;
+    // Computes the accumulator after move from the one before it; position is the position before the move
+    void update(const Position& position, Move move, const Accumulator& parent, Accumulator& child) const;
+    // Centipawn score from the side to move's point of view
+    int evaluate(const Accumulator& accumulator, PieceColour sideToMove) const;
+
+private:
+    struct Weights;
+    std::unique_ptr<Weights> weights;
+    bool loaded;
+};
+
+#endif // NNUE_H
@@ -0,0 +1,228 @@
+// Headless perft/divide tool for checking and timing the move generator.
+//
+//   perft [--bulk] [--hash MB] <depth> [fen]    count leaf nodes
+//   perft [--bulk] [--hash MB] divide <depth> [fen]    per root move counts
+//   perft [--bulk] [--hash MB] suite [maxDepth]    standard positions against known counts
+//
+// The suite also checks that illegal FENs are rejected, and exits with a non-zero status
+// if any count is wrong or any of them is accepted.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "position.h"
+#include "fen.h"
+#include "movegen.h"
+
+namespace {
+
+const std::string StartFen = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+struct SuitePosition {
+    const char* name;
+    const char* fen;
+    // Expected node counts for depth 1, 2, ...
+    std::vector<uint64_t> counts;
+};
+
+// Positions and counts from https://www.chessprogramming.org/Perft_Results
+const std::vector<SuitePosition> Suite = {
+    { "startpos", "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+      { 20, 400, 8902, 197281, 4865609, 119060324 } },
+    { "kiwipete", "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+      { 48, 2039, 97862, 4085603, 193690690 } },
+    { "position3", "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+      { 14, 191, 2812, 43238, 674624, 11030083 } },
+    { "position4", "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+      { 6, 264, 9467, 422333, 15833292 } },
+    { "position5", "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+      { 44, 1486, 62379, 2103487, 89941194 } },
+    { "position6", "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+      { 46, 2079, 89890, 3894594, 164075551 } },
+};
+
+// Every one of these must be rejected by parseFen; move generation assumes a legal position
+const char* const RejectedFens[] = {
+    "k7/8/8/8/8/8/8/RK6 w - - 0 1",
+    "k7/8/8/8/8/8/8/1K4r1 b - - 0 1",
+    "k7/8/8/8/8/8/1n6/3K4 b - - 0 1",
+    "8/8/8/8/8/8/8/RK6 w - - 0 1",
+    "k7/8/8/8/8/8/8/KP6 w - - 0 1",
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq e3 0 1",
+    "4k3/8/8/3P4/8/8/8/4K3 w - e6 0 1",
+    "4k3/8/4p3/3P4/8/8/8/4K3 w - e6 0 1",
+    "4k3/4p3/8/3Pp3/8/8/8/4K3 w - e6 0 1",
+    "rnbqkbnr/pppppppp/9/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+};
+
+// Subtree counts keyed by position and depth; always-replace, one entry per slot
+struct PerftEntry {
+    uint64_t key;
+    uint64_t nodes;
+    int depth;
+};
+
+class Perft {
+public:
+    Perft(bool bulk, size_t hashMegabytes) : bulk(bulk) {
+        size_t count = hashMegabytes * 1024 * 1024 / sizeof(PerftEntry);
+        if (count) table.assign(count, PerftEntry{ 0, 0, 0 });
+    }
+
+    uint64_t count(Position& position, int depth) {
+        if (depth == 0) return 1;
+
+        PerftEntry* entry = nullptr;
+        if (!table.empty()) {
+            entry = &table[position.getKey() % table.size()];
+            if (entry->depth == depth && entry->key == position.getKey()) return entry->nodes;
+        }
+
+        MoveList moves;
+        generateLegalMoves(position, moves);
+        uint64_t nodes = 0;
+        // Bulk counting stops at the last ply: every legal move there is one leaf
+        if (bulk && depth == 1) {
+            nodes = moves.size();
+        } else {
+            for (Move move : moves) {
+                position.makeMove(move);
+                nodes += count(position, depth - 1);
+                position.unmakeMove(move);
+            }
+        }
+
+        if (entry) *entry = PerftEntry{ position.getKey(), nodes, depth };
+        return nodes;
+    }
+
+    // Prints the subtree size of every legal root move
+    uint64_t divide(Position& position, int depth) {
+        MoveList moves;
+        generateLegalMoves(position, moves);
+        uint64_t total = 0;
+        for (Move move : moves) {
+            position.makeMove(move);
+            uint64_t nodes = count(position, depth - 1);
+            position.unmakeMove(move);
+            std::cout << move.toString() << ": " << nodes << std::endl;
+            total += nodes;
+        }
+        return total;
+    }
+
+private:
+    bool bulk;
+    std::vector<PerftEntry> table;
+};
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void printResult(uint64_t nodes, double seconds) {
+    uint64_t nps = seconds > 0 ? static_cast<uint64_t>(nodes / seconds) : 0;
+    std::cout << "nodes " << nodes << " time " << static_cast<int64_t>(seconds * 1000) << "ms nps " << nps << std::endl;
+}
+
+int runSuite(Perft& perft, int maxDepth) {
+    int failures = 0;
+    uint64_t totalNodes = 0;
+    auto suiteStart = std::chrono::steady_clock::now();
+    for (const SuitePosition& test : Suite) {
+        Position position;
+        parseFen(test.fen, position);
+        int depth = std::max(1, std::min<int>(maxDepth, static_cast<int>(test.counts.size())));
+        uint64_t expected = test.counts[depth - 1];
+
+        auto start = std::chrono::steady_clock::now();
+        uint64_t nodes = perft.count(position, depth);
+        double seconds = secondsSince(start);
+        totalNodes += nodes;
+
+        bool ok = nodes == expected;
+        if (!ok) failures++;
+        std::cout << (ok ? "ok   " : "FAIL ") << test.name << " depth " << depth
+                  << " expected " << expected << " got " << nodes << " ";
+        printResult(nodes, seconds);
+    }
+    for (const char* fen : RejectedFens) {
+        Position position;
+        FenError error;
+        bool ok = !parseFen(fen, position, &error);
+        if (!ok) failures++;
+        std::cout << (ok ? "ok   " : "FAIL ") << "rejects " << fen;
+        if (ok) std::cout << " (" << error.message << ")";
+        std::cout << std::endl;
+    }
+    std::cout << "total ";
+    printResult(totalNodes, secondsSince(suiteStart));
+    std::cout << (failures ? "suite FAILED" : "suite passed") << std::endl;
+    return failures ? 1 : 0;
+}
+
+// Joins the remaining arguments into a FEN, or returns the start position if there are none
+std::string fenFromArgs(const std::vector<std::string>& args, size_t first) {
+    if (first >= args.size()) return StartFen;
+    std::string fen = args[first];
+    for (size_t i = first + 1; i < args.size(); ++i) fen += " " + args[i];
+    return fen;
+}
+
+void printUsage() {
+    std::cerr << "usage: perft [--bulk] [--hash MB] <depth> [fen]\n"
+              << "       perft [--bulk] [--hash MB] divide <depth> [fen]\n"
+              << "       perft [--bulk] [--hash MB] suite [maxDepth]" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    bool bulk = false;
+    size_t hashMegabytes = 0;
+    std::vector<std::string> args;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--bulk") {
+            bulk = true;
+        } else if (arg == "--hash" && i + 1 < argc) {
+            hashMegabytes = std::strtoul(argv[++i], nullptr, 10);
+        } else {
+            args.push_back(arg);
+        }
+    }
+    if (args.empty()) {
+        printUsage();
+        return 2;
+    }
+
+    Perft perft(bulk, hashMegabytes);
+    if (args[0] == "suite") {
+        return runSuite(perft, args.size() > 1 ? std::atoi(args[1].c_str()) : 5);
+    }
+
+    bool divide = args[0] == "divide";
+    size_t depthArg = divide ? 1 : 0;
+    int depth = depthArg < args.size() ? std::atoi(args[depthArg].c_str()) : 0;
+    if (depth < 1) {
+        printUsage();
+        return 2;
+    }
+
+    Position position;
+    FenError error;
+    if (!parseFen(fenFromArgs(args, depthArg + 1), position, &error)) {
+        std::cerr << "invalid fen: " << error.message << " at column " << error.offset + 1 << std::endl;
+        return 2;
+    }
+    auto start = std::chrono::steady_clock::now();
+    uint64_t nodes = divide ? perft.divide(position, depth) : perft.count(position, depth);
+    double seconds = secondsSince(start);
+    if (divide) std::cout << std::endl;
+    printResult(nodes, seconds);
+    return 0;
+}
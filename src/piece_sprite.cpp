@@ -0,0 +1,59 @@
+#include "piece_sprite.h"
+
+PieceSprite::PieceSprite(const sf::Texture& atlas, const sf::IntRect& textureRect, int x, int y, int squareSize,
+                         PieceColour colour, PieceType type)
+    : piece(makePiece(type, colour)), x(x), y(y) {
+    sprite.setTexture(atlas);
+    sprite.setTextureRect(textureRect);
+    float scale = 0.8f;
+    sprite.setScale(scale, scale);
+    sprite.setPosition(x + squareSize / 2 - sprite.getGlobalBounds().width / 2,
+                       y + squareSize / 2 - sprite.getGlobalBounds().height / 2);
+}
+
+void PieceSprite::appendTo(sf::VertexArray& vertices) const {
+    sf::FloatRect bounds = sprite.getGlobalBounds();
+    sf::IntRect rect = sprite.getTextureRect();
+    float left = bounds.left, top = bounds.top;
+    float right = left + bounds.width, bottom = top + bounds.height;
+    float u0 = rect.left, v0 = rect.top;
+    float u1 = u0 + rect.width, v1 = v0 + rect.height;
+    vertices.append(sf::Vertex(sf::Vector2f(left, top), sf::Vector2f(u0, v0)));
+    vertices.append(sf::Vertex(sf::Vector2f(right, top), sf::Vector2f(u1, v0)));
+    vertices.append(sf::Vertex(sf::Vector2f(right, bottom), sf::Vector2f(u1, v1)));
+    vertices.append(sf::Vertex(sf::Vector2f(left, top), sf::Vector2f(u0, v0)));
+    vertices.append(sf::Vertex(sf::Vector2f(right, bottom), sf::Vector2f(u1, v1)));
+    vertices.append(sf::Vertex(sf::Vector2f(left, bottom), sf::Vector2f(u0, v1)));
+}
+
+sf::Vector2f PieceSprite::getPosition() const {
+    return sprite.getPosition();
+}
+
+sf::FloatRect PieceSprite::getBounds() const {
+    return sprite.getGlobalBounds();
+}
+
+PieceColour PieceSprite::getColour() const {
+    return colourOf(piece);
+}
+
+PieceType PieceSprite::getType() const {
+    return typeOf(piece);
+}
+
+sf::Vector2i PieceSprite::getBoardPosition() const {
+    return sf::Vector2i(x, y);
+}
+
+std::string PieceSprite::getTypeAsString() const {
+    switch (getType()) {
+        case PieceType::King: return "King";
+        case PieceType::Queen: return "Queen";
+        case PieceType::Rook: return "Rook";
+        case PieceType::Bishop: return "Bishop";
+        case PieceType::Knight: return "Knight";
+        case PieceType::Pawn: return "Pawn";
+        default: return "Unknown";
+    }
+}
@@ -0,0 +1,30 @@
+#ifndef PIECE_SPRITE_H
+#define PIECE_SPRITE_H
+
+#include <SFML/Graphics.hpp>
+#include <string>
+#include "types.h"
+
+// GUI view of one piece: where the board window draws it and which part of the piece atlas it shows.
+// The game state itself lives in Position as one-byte Piece codes; the atlas belongs to the Board.
+class PieceSprite {
+public:
+    PieceSprite(const sf::Texture& atlas, const sf::IntRect& textureRect, int x, int y, int squareSize,
+                PieceColour colour, PieceType type);
+    // Adds the two triangles of this piece to the board's batch, drawn with the atlas in one call
+    void appendTo(sf::VertexArray& vertices) const;
+    sf::Vector2f getPosition() const;
+    sf::FloatRect getBounds() const;
+    PieceColour getColour() const;
+    PieceType getType() const;
+    std::string getTypeAsString() const;
+    sf::Vector2i getBoardPosition() const;
+
+private:
+    sf::Sprite sprite;
+    Piece piece;
+    int x;
+    int y;
+};
+
+#endif // PIECE_SPRITE_H
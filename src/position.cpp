@@ -0,0 +1,332 @@
+#include "position.h"
+#include <algorithm>
+#include <type_traits>
+
+namespace {
+
+struct ZobristKeys {
+    uint64_t pieces[2][6][64];
+    uint64_t castling[16];
+    uint64_t enPassant[8];
+    uint64_t side;
+};
+
+// splitmix64, seeded with a constant so keys are identical from run to run
+uint64_t nextRandom(uint64_t& state) {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+ZobristKeys keys;
+
+bool initZobristKeys() {
+    uint64_t state = 1070372;
+    for (int c = 0; c < 2; ++c) {
+        for (int t = 0; t < 6; ++t) {
+            for (int square = 0; square < 64; ++square) {
+                keys.pieces[c][t][square] = nextRandom(state);
+            }
+        }
+    }
+    // Each right gets its own key and combinations are their XOR, so "no rights" hashes to 0
+    uint64_t rightKeys[4];
+    for (int i = 0; i < 4; ++i) {
+        rightKeys[i] = nextRandom(state);
+    }
+    for (int rights = 0; rights < 16; ++rights) {
+        keys.castling[rights] = 0;
+        for (int i = 0; i < 4; ++i) {
+            if (rights & (1 << i)) keys.castling[rights] ^= rightKeys[i];
+        }
+    }
+    for (int file = 0; file < 8; ++file) {
+        keys.enPassant[file] = nextRandom(state);
+    }
+    keys.side = nextRandom(state);
+    return true;
+}
+
+uint64_t pieceKey(PieceType type, PieceColour colour, int square) {
+    return keys.pieces[static_cast<int>(colour)][static_cast<int>(type)][square];
+}
+
+uint64_t enPassantKey(int square) {
+    return square == NoSquare ? 0 : keys.enPassant[fileOf(square)];
+}
+
+// Rights that survive a move touching each square; moving a king or rook, or capturing a rook, loses them
+int castlingMask(int square) {
+    switch (square) {
+        case 0: return ~WhiteQueenside;
+        case 4: return ~(WhiteKingside | WhiteQueenside);
+        case 7: return ~WhiteKingside;
+        case 56: return ~BlackQueenside;
+        case 60: return ~(BlackKingside | BlackQueenside);
+        case 63: return ~BlackKingside;
+        default: return AllCastling;
+    }
+}
+
+} // namespace
+
+// Search threads, the PV walk and batch workers copy positions with a plain memcpy
+static_assert(std::is_trivially_copyable<Position>::value, "Position must stay trivially copyable");
+// The undo ring is most of a Position; growing it makes every copy above dearer
+static_assert(sizeof(Position) <= 8 * 1024, "Position has outgrown its copy budget");
+
+Position::Position() {
+    initBitboards();
+    initPsqt();
+    static const bool zobristInitialised = initZobristKeys();
+    (void)zobristInitialised;
+    clear();
+}
+
+void Position::clear() {
+    for (int c = 0; c < 2; ++c) {
+        for (int t = 0; t < 6; ++t) {
+            pieceBB[c][t] = 0;
+        }
+        colourBB[c] = 0;
+    }
+    occupiedBB = 0;
+    for (int square = 0; square < 64; ++square) board[square] = NoPiece;
+    sideToMove = PieceColour::White;
+    castlingRights = 0;
+    enPassantSquare = NoSquare;
+    halfmoveClock = 0;
+    fullmoveNumber = 1;
+    key = 0;
+    midgameScore = 0;
+    endgameScore = 0;
+    phase = 0;
+    historySize = 0;
+}
+
+void Position::setSideToMove(PieceColour colour) {
+    if (colour != sideToMove) key ^= keys.side;
+    sideToMove = colour;
+}
+
+void Position::setCastlingRights(int rights) {
+    key ^= keys.castling[castlingRights] ^ keys.castling[rights];
+    castlingRights = rights;
+}
+
+void Position::setEnPassantSquare(int square) {
+    key ^= enPassantKey(enPassantSquare) ^ enPassantKey(square);
+    enPassantSquare = square;
+}
+
+void Position::putPiece(PieceType type, PieceColour colour, int square) {
+    addPiece(type, colour, square);
+}
+
+void Position::removePiece(int square) {
+    PieceType type = typeOn(square);
+    if (type != PieceType::None) {
+        removePiece(type, colourOn(square), square);
+    }
+}
+
+void Position::addPiece(PieceType type, PieceColour colour, int square) {
+    Bitboard b = squareBB(square);
+    pieceBB[static_cast<int>(colour)][static_cast<int>(type)] |= b;
+    colourBB[static_cast<int>(colour)] |= b;
+    occupiedBB |= b;
+    board[square] = makePiece(type, colour);
+    key ^= pieceKey(type, colour, square);
+    midgameScore += psqtMidgame[static_cast<int>(colour)][static_cast<int>(type)][square];
+    endgameScore += psqtEndgame[static_cast<int>(colour)][static_cast<int>(type)][square];
+    phase += PhaseWeight[static_cast<int>(type)];
+}
+
+void Position::removePiece(PieceType type, PieceColour colour, int square) {
+    Bitboard b = squareBB(square);
+    pieceBB[static_cast<int>(colour)][static_cast<int>(type)] ^= b;
+    colourBB[static_cast<int>(colour)] ^= b;
+    occupiedBB ^= b;
+    board[square] = NoPiece;
+    key ^= pieceKey(type, colour, square);
+    midgameScore -= psqtMidgame[static_cast<int>(colour)][static_cast<int>(type)][square];
+    endgameScore -= psqtEndgame[static_cast<int>(colour)][static_cast<int>(type)][square];
+    phase -= PhaseWeight[static_cast<int>(type)];
+}
+
+void Position::movePiece(PieceType type, PieceColour colour, int from, int to) {
+    Bitboard fromTo = squareBB(from) | squareBB(to);
+    pieceBB[static_cast<int>(colour)][static_cast<int>(type)] ^= fromTo;
+    colourBB[static_cast<int>(colour)] ^= fromTo;
+    occupiedBB ^= fromTo;
+    board[to] = board[from];
+    board[from] = NoPiece;
+    key ^= pieceKey(type, colour, from) ^ pieceKey(type, colour, to);
+    const int (&midgame)[64] = psqtMidgame[static_cast<int>(colour)][static_cast<int>(type)];
+    const int (&endgame)[64] = psqtEndgame[static_cast<int>(colour)][static_cast<int>(type)];
+    midgameScore += midgame[to] - midgame[from];
+    endgameScore += endgame[to] - endgame[from];
+}
+
+void Position::makeMove(Move move) {
+    UndoInfo undo = { key, castlingRights, enPassantSquare, halfmoveClock, PieceType::None };
+    PieceColour us = sideToMove;
+    PieceColour them = opposite(us);
+    int from = move.from();
+    int to = move.to();
+    PieceType type = typeOn(from);
+
+    halfmoveClock++;
+    key ^= enPassantKey(enPassantSquare);
+    enPassantSquare = NoSquare;
+
+    switch (move.kind()) {
+        case MoveKind::Castling: {
+            // The king steps two squares and the rook hops over it
+            bool kingside = to > from;
+            int rookFrom = kingside ? to + 1 : to - 2;
+            int rookTo = kingside ? to - 1 : to + 1;
+            movePiece(PieceType::King, us, from, to);
+            movePiece(PieceType::Rook, us, rookFrom, rookTo);
+            break;
+        }
+        case MoveKind::EnPassant: {
+            int capturedSquare = us == PieceColour::White ? to - 8 : to + 8;
+            removePiece(PieceType::Pawn, them, capturedSquare);
+            movePiece(PieceType::Pawn, us, from, to);
+            undo.captured = PieceType::Pawn;
+            halfmoveClock = 0;
+            break;
+        }
+        default: {
+            PieceType captured = typeOn(to);
+            if (captured != PieceType::None) {
+                removePiece(captured, them, to);
+                undo.captured = captured;
+                halfmoveClock = 0;
+            }
+            if (move.kind() == MoveKind::Promotion) {
+                removePiece(PieceType::Pawn, us, from);
+                addPiece(move.promotion(), us, to);
+            } else {
+                movePiece(type, us, from, to);
+            }
+            if (type == PieceType::Pawn) {
+                halfmoveClock = 0;
+                // Only record the en passant square when an enemy pawn could actually take
+                if ((to ^ from) == 16) {
+                    int passed = (from + to) / 2;
+                    if (pawnAttacks(us, passed) & pieces(them, PieceType::Pawn)) {
+                        enPassantSquare = passed;
+                        key ^= enPassantKey(passed);
+                    }
+                }
+            }
+            break;
+        }
+    }
+
+    int rights = castlingRights & castlingMask(from) & castlingMask(to);
+    key ^= keys.castling[castlingRights] ^ keys.castling[rights] ^ keys.side;
+    castlingRights = rights;
+    if (us == PieceColour::Black) fullmoveNumber++;
+    sideToMove = them;
+    pushUndo(undo);
+}
+
+void Position::unmakeMove(Move move) {
+    const UndoInfo& undo = undoAt(1);
+    PieceColour them = sideToMove;
+    PieceColour us = opposite(them);
+    int from = move.from();
+    int to = move.to();
+
+    switch (move.kind()) {
+        case MoveKind::Castling: {
+            bool kingside = to > from;
+            int rookFrom = kingside ? to + 1 : to - 2;
+            int rookTo = kingside ? to - 1 : to + 1;
+            movePiece(PieceType::King, us, to, from);
+            movePiece(PieceType::Rook, us, rookTo, rookFrom);
+            break;
+        }
+        case MoveKind::EnPassant:
+            movePiece(PieceType::Pawn, us, to, from);
+            addPiece(PieceType::Pawn, them, us == PieceColour::White ? to - 8 : to + 8);
+            break;
+        case MoveKind::Promotion:
+            removePiece(move.promotion(), us, to);
+            addPiece(PieceType::Pawn, us, from);
+            if (undo.captured != PieceType::None) addPiece(undo.captured, them, to);
+            break;
+        default:
+            movePiece(typeOn(to), us, to, from);
+            if (undo.captured != PieceType::None) addPiece(undo.captured, them, to);
+            break;
+    }
+
+    // Restoring the key wholesale is cheaper than undoing each XOR above
+    key = undo.key;
+    castlingRights = undo.castlingRights;
+    enPassantSquare = undo.enPassantSquare;
+    halfmoveClock = undo.halfmoveClock;
+    if (us == PieceColour::Black) fullmoveNumber--;
+    sideToMove = us;
+    historySize--;
+}
+
+void Position::makeNullMove() {
+    pushUndo({ key, castlingRights, enPassantSquare, halfmoveClock, PieceType::None });
+    key ^= enPassantKey(enPassantSquare) ^ keys.side;
+    enPassantSquare = NoSquare;
+    halfmoveClock = 0;
+    sideToMove = opposite(sideToMove);
+}
+
+void Position::unmakeNullMove() {
+    const UndoInfo& undo = undoAt(1);
+    key = undo.key;
+    enPassantSquare = undo.enPassantSquare;
+    halfmoveClock = undo.halfmoveClock;
+    sideToMove = opposite(sideToMove);
+    historySize--;
+}
+
+bool Position::isRepetition() const {
+    // Only positions since the last irreversible move can repeat, and only with the same side to move
+    int end = std::min({ halfmoveClock, historySize, MaxHistory });
+    for (int i = 4; i <= end; i += 2) {
+        if (undoAt(i).key == key) return true;
+    }
+    return false;
+}
+
+int Position::repetitionCount() const {
+    int end = std::min({ halfmoveClock, historySize, MaxHistory });
+    int count = 0;
+    for (int i = 4; i <= end; i += 2) {
+        if (undoAt(i).key == key) ++count;
+    }
+    return count;
+}
+
+int Position::kingSquare(PieceColour colour) const {
+    Bitboard kings = pieces(colour, PieceType::King);
+    return kings ? lsb(kings) : NoSquare;
+}
+
+Bitboard Position::attackersTo(int square, Bitboard occupied) const {
+    Bitboard rooks = pieces(PieceType::Rook) | pieces(PieceType::Queen);
+    Bitboard bishops = pieces(PieceType::Bishop) | pieces(PieceType::Queen);
+    return (pawnAttacks(PieceColour::White, square) & pieces(PieceColour::Black, PieceType::Pawn))
+        | (pawnAttacks(PieceColour::Black, square) & pieces(PieceColour::White, PieceType::Pawn))
+        | (knightAttacks(square) & pieces(PieceType::Knight))
+        | (kingAttacks(square) & pieces(PieceType::King))
+        | (rookAttacks(square, occupied) & rooks)
+        | (bishopAttacks(square, occupied) & bishops);
+}
+
+Bitboard Position::checkers() const {
+    return attackersTo(kingSquare(sideToMove)) & pieces(opposite(sideToMove));
+}
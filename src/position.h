@@ -0,0 +1,124 @@
+#ifndef POSITION_H
+#define POSITION_H
+
+#include "types.h"
+#include "bitboard.h"
+#include "move.h"
+#include "psqt.h"
+
+// Everything makeMove overwrites that cannot be recomputed when the move is taken back
+struct UndoInfo {
+    uint64_t key;
+    int castlingRights;
+    int enPassantSquare;
+    int halfmoveClock;
+    PieceType captured;
+};
+
+// Undo entries a Position keeps, as a ring over the latest moves. Only those are ever read back:
+// moves are taken back at most a search deep, and a repetition cannot reach past the last capture
+// or pawn move, which the fifty-move rule keeps within 100 plies.
+// The ring is held inline on purpose, making a Position about 6.4 KB but trivially copyable.
+// Positions are only copied when a search, a PV walk or a batch job is set up, never per node,
+// so one allocation-free memcpy there is cheaper than a separate undo stack that every copy
+// would have to be rewired to.
+constexpr int MaxHistory = 256;
+static_assert((MaxHistory & (MaxHistory - 1)) == 0, "MaxHistory must be a power of two");
+
+// Headless board state shared by the GUI and the engine.
+// Each piece type and colour has its own bitboard so occupancy queries are a single AND,
+// and a mailbox answers "what is on this square" with a single load.
+class Position {
+public:
+    Position();
+    // An empty board; parseFen in fen.h sets up a position from a FEN string
+    void clear();
+
+    void putPiece(PieceType type, PieceColour colour, int square);
+    void removePiece(int square);
+
+    // Moves are applied in place and taken back from the undo stack, never by copying the position
+    void makeMove(Move move);
+    void unmakeMove(Move move);
+    // Passes the turn, for null-move pruning. The halfmove clock restarts so that no
+    // repetition is detected across the null move.
+    void makeNullMove();
+    void unmakeNullMove();
+
+    // Zobrist key of the position, kept up to date incrementally
+    uint64_t getKey() const { return key; }
+    // True if the position occurred before since the last capture or pawn move
+    bool isRepetition() const;
+    // How often the position occurred before since the last capture or pawn move; the game is
+    // drawn once this reaches two
+    int repetitionCount() const;
+
+    Bitboard occupied() const { return occupiedBB; }
+    Bitboard pieces(PieceColour colour) const { return colourBB[static_cast<int>(colour)]; }
+    Bitboard pieces(PieceColour colour, PieceType type) const {
+        return pieceBB[static_cast<int>(colour)][static_cast<int>(type)];
+    }
+    Bitboard pieces(PieceType type) const {
+        return pieceBB[0][static_cast<int>(type)] | pieceBB[1][static_cast<int>(type)];
+    }
+
+    bool isEmpty(int square) const { return !(occupiedBB & squareBB(square)); }
+    Piece pieceOn(int square) const { return board[square]; }
+    PieceType typeOn(int square) const { return typeOf(board[square]); }
+    PieceColour colourOn(int square) const { return colourOf(board[square]); }
+    int kingSquare(PieceColour colour) const;
+
+    // Pieces of both colours attacking square, found by reverse lookups from the square.
+    // The occupancy can differ from the board, e.g. with a piece lifted off for SEE.
+    Bitboard attackersTo(int square, Bitboard occupied) const;
+    Bitboard attackersTo(int square) const { return attackersTo(square, occupiedBB); }
+    // Enemy pieces giving check to the side to move
+    Bitboard checkers() const;
+    bool inCheck() const { return checkers() != 0; }
+
+    PieceColour getSideToMove() const { return sideToMove; }
+    void setSideToMove(PieceColour colour);
+    int getCastlingRights() const { return castlingRights; }
+    void setCastlingRights(int rights);
+    int getEnPassantSquare() const { return enPassantSquare; }
+    void setEnPassantSquare(int square);
+    int getHalfmoveClock() const { return halfmoveClock; }
+    void setHalfmoveClock(int clock) { halfmoveClock = clock; }
+    // Starts at 1 and goes up after each Black move
+    int getFullmoveNumber() const { return fullmoveNumber; }
+    void setFullmoveNumber(int number) { fullmoveNumber = number; }
+
+    // Material and piece-square sums from White's point of view, kept up to date as pieces move
+    int getMidgameScore() const { return midgameScore; }
+    int getEndgameScore() const { return endgameScore; }
+    // MaxPhase with all pieces on the board, falling towards 0 as they are traded
+    int getPhase() const { return phase; }
+
+private:
+    Bitboard pieceBB[2][6];
+    Bitboard colourBB[2];
+    Bitboard occupiedBB;
+    Piece board[64];
+    PieceColour sideToMove;
+    int castlingRights;
+    int enPassantSquare;
+    int halfmoveClock;
+    int fullmoveNumber;
+    uint64_t key;
+    int midgameScore;
+    int endgameScore;
+    int phase;
+    UndoInfo history[MaxHistory];
+    // Moves made since clear(), including those whose entries the ring has overwritten
+    int historySize;
+
+    void pushUndo(const UndoInfo& undo) { history[historySize++ & (MaxHistory - 1)] = undo; }
+    // The entry of the move made pliesAgo moves back, 1 being the last one
+    const UndoInfo& undoAt(int pliesAgo) const { return history[(historySize - pliesAgo) & (MaxHistory - 1)]; }
+
+    void addPiece(PieceType type, PieceColour colour, int square);
+    void removePiece(PieceType type, PieceColour colour, int square);
+    void movePiece(PieceType type, PieceColour colour, int from, int to);
+};
+
+#endif // POSITION_H
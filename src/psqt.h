@@ -0,0 +1,19 @@
+#ifndef PSQT_H
+#define PSQT_H
+
+#include "types.h"
+
+// Piece values plus piece-square bonuses, for the middlegame and the endgame separately.
+// Entries are from White's point of view: Black pieces have negated values, so a position's
+// score is just the sum over its pieces.
+extern int psqtMidgame[2][6][64];
+extern int psqtEndgame[2][6][64];
+
+// Game phase contributed by each piece type, indexed by PieceType; the starting position is MaxPhase
+constexpr int PhaseWeight[6] = { 0, 4, 1, 1, 2, 0 };
+constexpr int MaxPhase = 24;
+
+// Fills the tables above. Safe to call more than once; only the first call does any work.
+void initPsqt();
+
+#endif // PSQT_H
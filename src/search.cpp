@@ -0,0 +1,400 @@
+#include "search.h"
+#include "movegen.h"
+#include "movepick.h"
+#include "see.h"
+#include "log.h"
+#include "stats.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+namespace {
+
+// The search takes back up to MaxPly moves and checks repetitions up to 100 plies before its root
+static_assert(MaxPly + 100 <= MaxHistory, "Position keeps too few undo entries for the search");
+
+// Mate scores are stored relative to the node so they stay valid when reached by another path
+int scoreToTT(int score, int ply) {
+    if (score >= MateBound) return score + ply;
+    if (score <= -MateBound) return score - ply;
+    return score;
+}
+
+int scoreFromTT(int score, int ply) {
+    if (score >= MateBound) return score - ply;
+    if (score <= -MateBound) return score + ply;
+    return score;
+}
+
+// A capture is skipped in quiescence search if even winning the piece plus this much
+// would not lift the score to alpha
+constexpr int DeltaMargin = 200;
+
+// Helper threads skip some iterations so that they spread over different depths
+// instead of all searching the same tree in lockstep with the main thread
+const int SkipSize[20] = { 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 4, 4, 4, 4, 4, 4, 4, 4 };
+const int SkipPhase[20] = { 0, 1, 0, 1, 2, 3, 0, 1, 2, 3, 4, 5, 0, 1, 2, 3, 4, 5, 6, 7 };
+
+} // namespace
+
+SearchThread::SearchThread(Engine& engine, int id)
+    : engine(engine), id(id), nodes(0), rootBestMove(Move::none()), bestMove(Move::none()),
+      bestScore(-Infinite), completedDepth(0), useNnue(false) {
+}
+
+void SearchThread::setPosition(const Position& root) {
+    position = root;
+    nodes.store(0, std::memory_order_relaxed);
+    rootBestMove = bestMove = Move::none();
+    bestScore = -Infinite;
+    completedDepth = 0;
+    useNnue = engine.useNnue && engine.network.isLoaded();
+    history.clear();
+    for (auto& plyKillers : killers) plyKillers[0] = plyKillers[1] = Move::none();
+
+    const SearchParams& params = engine.params;
+    for (int depth = 0; depth < 64; ++depth) {
+        for (int moveCount = 0; moveCount < 64; ++moveCount) {
+            double reduction = params.lmrBase / 100.0;
+            if (depth > 0 && moveCount > 0) {
+                reduction += std::log(depth) * std::log(moveCount) / (params.lmrDivisor / 100.0);
+            }
+            reductions[depth][moveCount] = static_cast<int>(reduction);
+        }
+    }
+    if (useNnue) engine.network.refresh(position, accumulators[0]);
+}
+
+bool SearchThread::shouldStop() const {
+    return engine.stopRequested.load(std::memory_order_relaxed);
+}
+
+void SearchThread::countNode() {
+    // Only this thread writes the counter, so a plain load/store pair avoids a locked increment
+    uint64_t count = nodes.load(std::memory_order_relaxed) + 1;
+    nodes.store(count, std::memory_order_relaxed);
+    if (isMainThread() && (count & 1023) == 0) engine.checkLimits();
+}
+
+void SearchThread::makeMove(Move move, int ply) {
+    // The update needs the position before the move to see what is captured
+    if (useNnue) engine.network.update(position, move, accumulators[ply], accumulators[ply + 1]);
+    position.makeMove(move);
+}
+
+void SearchThread::unmakeMove(Move move) {
+    // The parent accumulator is still on the stack, so only the board needs restoring
+    position.unmakeMove(move);
+}
+
+void SearchThread::makeNullMove(int ply) {
+    // Nothing moves, so the child accumulator is a plain copy
+    if (useNnue) accumulators[ply + 1] = accumulators[ply];
+    position.makeNullMove();
+}
+
+void SearchThread::unmakeNullMove() {
+    position.unmakeNullMove();
+}
+
+int SearchThread::evaluate(int ply) const {
+    CHESS_STAT_TIMER(evalTime);
+    if (!useNnue) return Engine::evaluateBoard(position);
+    // Keep network scores clear of the mate range
+    int score = engine.network.evaluate(accumulators[ply], position.getSideToMove());
+    return std::max(-MateBound + 1, std::min(MateBound - 1, score));
+}
+
+void SearchThread::updateQuietStats(Move best, const MoveList& quietsSearched, int depth, int ply) {
+    if (killers[ply][0] != best) {
+        killers[ply][1] = killers[ply][0];
+        killers[ply][0] = best;
+    }
+    PieceColour us = position.getSideToMove();
+    int bonus = std::min(depth * depth * 16, 1600);
+    history.update(us, best, bonus);
+    for (Move move : quietsSearched) history.update(us, move, -bonus);
+}
+
+void SearchThread::generateRootMoves(MoveList& moves) const {
+    CHESS_STAT_TIMER(movegenTime);
+    MoveList legal;
+    generateLegalMoves(position, legal);
+    const std::vector<Move>& allowed = engine.limits.searchMoves;
+    for (Move move : legal) {
+        if (allowed.empty() || std::find(allowed.begin(), allowed.end(), move) != allowed.end()) moves.add(move);
+    }
+}
+
+void SearchThread::iterativeDeepening() {
+#ifdef CHESS_STATS_ENABLED
+    threadStats.clear();
+    // Handed to the engine however the search ends
+    struct PublishStats {
+        SearchStats& target;
+        ~PublishStats() { target = threadStats; }
+    } publishStats{stats};
+#endif
+    MoveList rootMoves;
+    generateRootMoves(rootMoves);
+    if (rootMoves.empty()) return;
+
+    // Whatever happens there is always a move to play
+    bestMove = rootBestMove = rootMoves[0];
+    const SearchLimits& limits = engine.limits;
+    int maxDepth = limits.depth > 0 ? std::min(limits.depth, MaxPly - 1) : MaxPly - 1;
+
+    for (int depth = 1; depth <= maxDepth; ++depth) {
+        if (!isMainThread()) {
+            int i = (id - 1) % 20;
+            if (((depth + SkipPhase[i]) / SkipSize[i]) % 2) continue;
+        }
+
+        [[maybe_unused]] uint64_t nodesBefore = getNodes();
+        int score = searchRoot(depth, -Infinite, Infinite);
+        // An interrupted iteration is incomplete, keep the previous result
+        if (shouldStop()) break;
+        CHESS_STAT_ITERATION(depth, getNodes() - nodesBefore);
+        bestMove = rootBestMove;
+        bestScore = score;
+        completedDepth = depth;
+        CHESS_TRACE("depth %d score %d best %s nodes %llu", depth, score, bestMove.toString().c_str(),
+                    static_cast<unsigned long long>(getNodes()));
+
+        if (isMainThread()) {
+            engine.reportIteration(depth, score, bestMove);
+            // A forced mate will not get any shorter by searching deeper
+            if (std::abs(score) >= MateBound && !limits.infinite) break;
+            // go mate N: a mate for us in N moves is N * 2 - 1 plies away
+            if (limits.mate > 0 && score >= MateScore - (limits.mate * 2 - 1)) break;
+            if (engine.isSoftLimitReached()) break;
+        }
+    }
+}
+
+int SearchThread::searchRoot(int depth, int alpha, int beta) {
+    MoveList moves;
+    generateRootMoves(moves);
+
+    // Search the best move of the previous iteration first
+    for (int i = 0; i < moves.size(); ++i) {
+        if (moves[i] == rootBestMove) {
+            std::swap(moves[0], moves[i]);
+            break;
+        }
+    }
+
+    int bestRootScore = -Infinite;
+    Move bestRootMove = moves[0];
+    countNode();
+    CHESS_STAT_INC(nodes);
+    for (int i = 0; i < moves.size(); ++i) {
+        Move move = moves[i];
+        makeMove(move, 0);
+        int score;
+        if (i == 0) {
+            score = -negamax(depth - 1, 1, -beta, -alpha);
+        } else {
+            score = -negamax(depth - 1, 1, -alpha - 1, -alpha);
+            if (score > alpha && score < beta) score = -negamax(depth - 1, 1, -beta, -alpha);
+        }
+        unmakeMove(move);
+        if (shouldStop()) return 0;
+
+        if (score > bestRootScore) {
+            bestRootScore = score;
+            bestRootMove = move;
+            if (score > alpha) alpha = score;
+            if (i > 0) CHESS_TRACE("depth %d new best %s score %d", depth, move.toString().c_str(), score);
+        }
+    }
+    rootBestMove = bestRootMove;
+    engine.tt.store(position.getKey(), bestRootMove, scoreToTT(bestRootScore, 0), depth, Bound::Exact);
+    return bestRootScore;
+}
+
+int SearchThread::negamax(int depth, int ply, int alpha, int beta, bool nullAllowed) {
+    if (depth <= 0) {
+        CHESS_STAT_TIMER(qsearchTime);
+        return quiescence(ply, alpha, beta);
+    }
+
+    countNode();
+    CHESS_STAT_INC(nodes);
+    if (shouldStop()) return 0;
+
+    if (ply >= MaxPly) return evaluate(ply);
+    if (position.getHalfmoveClock() >= 100 || position.isRepetition()) return 0;
+
+    // A deep enough stored result with a usable bound ends the node right away
+    uint64_t key = position.getKey();
+    TTEntry entry;
+    Move ttMove = Move::none();
+    CHESS_STAT_INC(ttProbes);
+    if (engine.tt.probe(key, entry)) {
+        CHESS_STAT_INC(ttHits);
+        ttMove = entry.move;
+        int ttScore = scoreFromTT(entry.score, ply);
+        if (entry.depth >= depth
+            && (entry.bound == Bound::Exact
+                || (entry.bound == Bound::Lower && ttScore >= beta)
+                || (entry.bound == Bound::Upper && ttScore <= alpha))) {
+            CHESS_STAT_INC(ttCutoffs);
+            return ttScore;
+        }
+    }
+
+    const SearchParams& params = engine.params;
+    PieceColour us = position.getSideToMove();
+    bool pvNode = beta - alpha > 1;
+    bool inCheck = position.inCheck();
+    int staticEval = inCheck ? -Infinite : evaluate(ply);
+
+    if (!pvNode && !inCheck) {
+        // Reverse futility: far enough above beta that a shallow search will not fall below it
+        if (params.reverseFutility && depth <= params.reverseFutilityMaxDepth && beta > -MateBound && beta < MateBound
+            && staticEval - params.reverseFutilityMargin * depth >= beta) {
+            return staticEval;
+        }
+
+        // Null move: if passing still fails high, a real move almost certainly would too.
+        // Not with pawns and king alone, where zugzwang makes passing a real advantage.
+        Bitboard pieces = position.pieces(us) & ~position.pieces(us, PieceType::Pawn) & ~position.pieces(us, PieceType::King);
+        if (params.nullMove && nullAllowed && depth >= params.nullMoveMinDepth && staticEval >= beta && pieces) {
+            int reduction = params.nullMoveReduction + depth / params.nullMoveDepthDivisor;
+            makeNullMove(ply);
+            int score = -negamax(depth - 1 - reduction, ply + 1, -beta, -beta + 1, false);
+            unmakeNullMove();
+            if (shouldStop()) return 0;
+
+            if (score >= beta) {
+                // A mate found after passing is not a real mate
+                if (score >= MateBound) score = beta;
+                if (depth < params.nullMoveVerifyDepth) return score;
+                int verified = negamax(depth - 1 - reduction, ply, beta - 1, beta, false);
+                if (shouldStop()) return 0;
+                if (verified >= beta) return score;
+            }
+        }
+    }
+
+    // Futility: this close to the leaves, quiet moves cannot make up a large deficit
+    bool futile = params.futility && !pvNode && !inCheck && depth <= params.futilityMaxDepth
+        && alpha < MateBound && alpha > -MateBound
+        && staticEval + params.futilityMarginBase + params.futilityMarginPerDepth * depth <= alpha;
+
+    MovePicker picker(position, ttMove, killers[ply], history);
+    int originalAlpha = alpha;
+    int bestNodeScore = -Infinite;
+    Move bestNodeMove = Move::none();
+    int moveCount = 0;
+    // Quiet moves that failed to cut off, penalised if a later one does
+    MoveList quietsSearched;
+    Move move;
+    while (!(move = picker.next()).isNone()) {
+        moveCount++;
+        bool quiet = isQuiet(position, move);
+        // Quiet checks are kept: near the leaves they are often the only way to a mate
+        if (futile && quiet && moveCount > 1 && !givesCheck(position, move)) continue;
+
+        int historyScore = quiet ? history.get(us, move) : 0;
+        makeMove(move, ply);
+        bool givesCheck = position.inCheck();
+        int newDepth = depth - 1 + (params.checkExtensions && givesCheck ? 1 : 0);
+
+        int score;
+        if (moveCount == 1) {
+            score = -negamax(newDepth, ply + 1, -beta, -alpha);
+        } else {
+            // Late quiet moves are searched shallower first, less so if they have a good history
+            int reduction = 0;
+            if (params.lateMoveReductions && depth >= params.lmrMinDepth && moveCount > params.lmrMinMoves
+                && quiet && !inCheck && !givesCheck) {
+                reduction = reductions[std::min(depth, 63)][std::min(moveCount, 63)];
+                reduction -= historyScore / params.lmrHistoryDivisor;
+                if (pvNode) reduction--;
+                reduction = std::max(0, std::min(reduction, newDepth - 1));
+            }
+
+            // Everything after the first move only has to be proved no better than alpha
+            score = -negamax(newDepth - reduction, ply + 1, -alpha - 1, -alpha);
+            if (score > alpha && reduction > 0) {
+                score = -negamax(newDepth, ply + 1, -alpha - 1, -alpha);
+            }
+            if (score > alpha && score < beta) {
+                score = -negamax(newDepth, ply + 1, -beta, -alpha);
+            }
+        }
+        unmakeMove(move);
+        if (shouldStop()) return 0;
+
+        if (score > bestNodeScore) {
+            bestNodeScore = score;
+            bestNodeMove = move;
+            if (score > alpha) {
+                alpha = score;
+                if (alpha >= beta) {
+                    CHESS_STAT_INC(failHighs);
+                    if (moveCount == 1) CHESS_STAT_INC(failHighsFirst);
+                    if (quiet) updateQuietStats(move, quietsSearched, depth, ply);
+                    break;
+                }
+            }
+        }
+        if (quiet) quietsSearched.add(move);
+    }
+
+    // Checkmate or stalemate; prefer the quickest mate
+    if (moveCount == 0) return inCheck ? -MateScore + ply : 0;
+
+    Bound bound = bestNodeScore >= beta ? Bound::Lower : bestNodeScore > originalAlpha ? Bound::Exact : Bound::Upper;
+    engine.tt.store(key, bestNodeMove, scoreToTT(bestNodeScore, ply), depth, bound);
+    return bestNodeScore;
+}
+
+// Plays out captures and promotions until the position is quiet, so that the evaluation is
+// never taken halfway through an exchange
+int SearchThread::quiescence(int ply, int alpha, int beta) {
+    countNode();
+    CHESS_STAT_INC(qnodes);
+    if (shouldStop()) return 0;
+    if (ply >= MaxPly) return evaluate(ply);
+
+    // Stand pat: the side to move can usually do at least as well as the static score by
+    // not capturing. That does not hold in check, where every evasion is searched instead.
+    bool inCheck = position.inCheck();
+    int standPat = -Infinite;
+    int bestScore = -Infinite;
+    if (!inCheck) {
+        standPat = bestScore = evaluate(ply);
+        if (standPat >= beta) return standPat;
+        if (standPat > alpha) alpha = standPat;
+    }
+
+    MovePicker picker(position, history);
+    int moveCount = 0;
+    Move move;
+    while (!(move = picker.next()).isNone()) {
+        moveCount++;
+        if (!inCheck && move.kind() != MoveKind::Promotion) {
+            PieceType captured = move.kind() == MoveKind::EnPassant ? PieceType::Pawn : position.typeOn(move.to());
+            if (standPat + SeeValue[static_cast<int>(captured)] + DeltaMargin <= alpha) continue;
+        }
+
+        makeMove(move, ply);
+        int score = -quiescence(ply + 1, -beta, -alpha);
+        unmakeMove(move);
+        if (shouldStop()) return 0;
+
+        if (score > bestScore) {
+            bestScore = score;
+            if (score > alpha) {
+                alpha = score;
+                if (alpha >= beta) break;
+            }
+        }
+    }
+
+    if (inCheck && moveCount == 0) return -MateScore + ply;
+    return bestScore;
+}
@@ -0,0 +1,69 @@
+#ifndef SEARCH_H
+#define SEARCH_H
+
+#include <atomic>
+#include <cstdint>
+#include "position.h"
+#include "move.h"
+#include "nnue.h"
+#include "movepick.h"
+#include "engine.h"
+#include "stats.h"
+
+// One search thread. Each has its own copy of the root position; everything else it
+// learns is shared with the other threads through the engine's transposition table.
+class SearchThread {
+public:
+    SearchThread(Engine& engine, int id);
+
+    void setPosition(const Position& root);
+    // Runs until the depth limit is reached or the engine raises its stop flag
+    void iterativeDeepening();
+
+    uint64_t getNodes() const { return nodes.load(std::memory_order_relaxed); }
+    Move getBestMove() const { return bestMove; }
+    int getBestScore() const { return bestScore; }
+    int getCompletedDepth() const { return completedDepth; }
+    // Counters of the last search; only filled in when statistics are compiled in
+    const SearchStats& getStats() const { return stats; }
+
+private:
+    Engine& engine;
+    int id;
+    Position position;
+    // Written only by this thread, read by the main thread for reporting and node limits
+    std::atomic<uint64_t> nodes;
+    Move rootBestMove;
+    Move bestMove;
+    int bestScore;
+    int completedDepth;
+    SearchStats stats;
+    // Fixed for the whole search so that every node is scored the same way
+    bool useNnue;
+    // One accumulator per ply; accumulators[ply] matches the position at that ply
+    Accumulator accumulators[MaxPly + 1];
+    // Ordering heuristics, reset for every search
+    HistoryTable history;
+    Move killers[MaxPly + 1][2];
+    // Late move reductions by depth and move number, from the engine's SearchParams
+    int reductions[64][64];
+
+    bool isMainThread() const { return id == 0; }
+    bool shouldStop() const;
+    void countNode();
+    // Play and take back a move at ply, keeping the network accumulators in step
+    void makeMove(Move move, int ply);
+    void unmakeMove(Move move);
+    void makeNullMove(int ply);
+    void unmakeNullMove();
+    int evaluate(int ply) const;
+    // Legal root moves, restricted to the searchmoves of the limits if there are any
+    void generateRootMoves(MoveList& moves) const;
+    // Records a quiet move that caused a cutoff as a killer and in the history
+    void updateQuietStats(Move best, const MoveList& quietsSearched, int depth, int ply);
+    int searchRoot(int depth, int alpha, int beta);
+    int negamax(int depth, int ply, int alpha, int beta, bool nullAllowed = true);
+    int quiescence(int ply, int alpha, int beta);
+};
+
+#endif // SEARCH_H
@@ -0,0 +1,58 @@
+#include "see.h"
+
+bool seeGe(const Position& position, Move move, int threshold) {
+    // Castling and en passant never lose material; promotions are judged as plain moves
+    if (move.kind() == MoveKind::Castling || move.kind() == MoveKind::EnPassant) return threshold <= 0;
+
+    int from = move.from();
+    int to = move.to();
+
+    // swap is what the side to move is left with if the exchange stops here, minus threshold.
+    // If even keeping the first capture is not enough, or losing the mover still is, we are done.
+    int swap = SeeValue[static_cast<int>(position.typeOn(to))] - threshold;
+    if (swap < 0) return false;
+    swap = SeeValue[static_cast<int>(position.typeOn(from))] - swap;
+    if (swap <= 0) return true;
+
+    Bitboard occupied = position.occupied() ^ squareBB(from) ^ squareBB(to);
+    Bitboard attackers = position.attackersTo(to, occupied);
+    Bitboard bishops = position.pieces(PieceType::Bishop) | position.pieces(PieceType::Queen);
+    Bitboard rooks = position.pieces(PieceType::Rook) | position.pieces(PieceType::Queen);
+    PieceColour side = position.getSideToMove();
+    int result = 1;
+
+    while (true) {
+        side = opposite(side);
+        attackers &= occupied;
+        Bitboard sideAttackers = attackers & position.pieces(side);
+        if (!sideAttackers) break;
+        result ^= 1;
+
+        // Recapture with the least valuable piece; removing it can uncover a slider behind it
+        Bitboard b;
+        if ((b = sideAttackers & position.pieces(PieceType::Pawn))) {
+            if ((swap = SeeValue[static_cast<int>(PieceType::Pawn)] - swap) < result) break;
+            occupied ^= squareBB(lsb(b));
+            attackers |= bishopAttacks(to, occupied) & bishops;
+        } else if ((b = sideAttackers & position.pieces(PieceType::Knight))) {
+            if ((swap = SeeValue[static_cast<int>(PieceType::Knight)] - swap) < result) break;
+            occupied ^= squareBB(lsb(b));
+        } else if ((b = sideAttackers & position.pieces(PieceType::Bishop))) {
+            if ((swap = SeeValue[static_cast<int>(PieceType::Bishop)] - swap) < result) break;
+            occupied ^= squareBB(lsb(b));
+            attackers |= bishopAttacks(to, occupied) & bishops;
+        } else if ((b = sideAttackers & position.pieces(PieceType::Rook))) {
+            if ((swap = SeeValue[static_cast<int>(PieceType::Rook)] - swap) < result) break;
+            occupied ^= squareBB(lsb(b));
+            attackers |= rookAttacks(to, occupied) & rooks;
+        } else if ((b = sideAttackers & position.pieces(PieceType::Queen))) {
+            if ((swap = SeeValue[static_cast<int>(PieceType::Queen)] - swap) < result) break;
+            occupied ^= squareBB(lsb(b));
+            attackers |= (bishopAttacks(to, occupied) & bishops) | (rookAttacks(to, occupied) & rooks);
+        } else {
+            // Only the king is left: it may recapture only if nothing defends the square
+            return (attackers & ~position.pieces(side)) ? result ^ 1 : result;
+        }
+    }
+    return result;
+}
@@ -0,0 +1,15 @@
+#ifndef SEE_H
+#define SEE_H
+
+#include "move.h"
+#include "position.h"
+
+// Piece values for exchange evaluation, indexed by PieceType (None is an empty square)
+constexpr int SeeValue[7] = { 20000, 900, 330, 320, 500, 100, 0 };
+
+// Static exchange evaluation: true if the exchange started by move on its destination square
+// gains at least threshold for the side making it, assuming both sides keep recapturing with
+// their least valuable attacker for as long as that pays. Pins are ignored.
+bool seeGe(const Position& position, Move move, int threshold);
+
+#endif // SEE_H
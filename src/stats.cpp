@@ -0,0 +1,97 @@
+#include "stats.h"
+#include <iomanip>
+#include <sstream>
+
+#ifdef CHESS_STATS_ENABLED
+thread_local SearchStats threadStats;
+#endif
+
+namespace {
+
+double percent(uint64_t part, uint64_t whole) {
+    return whole ? 100.0 * part / whole : 0.0;
+}
+
+double milliseconds(uint64_t nanoseconds) {
+    return nanoseconds / 1e6;
+}
+
+} // namespace
+
+void SearchStats::merge(const SearchStats& other) {
+    nodes += other.nodes;
+    qnodes += other.qnodes;
+    ttProbes += other.ttProbes;
+    ttHits += other.ttHits;
+    ttCutoffs += other.ttCutoffs;
+    failHighs += other.failHighs;
+    failHighsFirst += other.failHighsFirst;
+    movegenTime += other.movegenTime;
+    evalTime += other.evalTime;
+    qsearchTime += other.qsearchTime;
+}
+
+double SearchStats::branchingFactor(int depth) const {
+    if (depth < 2 || depth > iterations || depth >= MaxDepth) return 0.0;
+    uint64_t previous = iterationNodes[depth - 1];
+    return previous ? static_cast<double>(iterationNodes[depth]) / previous : 0.0;
+}
+
+std::vector<std::string> formatStats(const SearchStats& stats) {
+    std::vector<std::string> lines;
+    std::ostringstream line;
+    line << std::fixed << std::setprecision(1);
+
+    uint64_t total = stats.nodes + stats.qnodes;
+    line << "nodes " << stats.nodes << " qnodes " << stats.qnodes << " (" << percent(stats.qnodes, total) << "%)";
+    lines.push_back(line.str());
+
+    line.str("");
+    line << "tt probes " << stats.ttProbes << " hits " << percent(stats.ttHits, stats.ttProbes)
+         << "% cutoffs " << percent(stats.ttCutoffs, stats.ttProbes) << '%';
+    lines.push_back(line.str());
+
+    line.str("");
+    line << "failhigh " << stats.failHighs << " first " << percent(stats.failHighsFirst, stats.failHighs) << '%';
+    lines.push_back(line.str());
+
+    if (stats.iterations >= 2) {
+        line.str("");
+        line << std::setprecision(2) << "ebf";
+        for (int depth = 2; depth <= stats.iterations; ++depth) {
+            line << ' ' << depth << ':' << stats.branchingFactor(depth);
+        }
+        lines.push_back(line.str());
+    }
+
+    line.str("");
+    line << std::setprecision(1) << "time movegen " << milliseconds(stats.movegenTime) << "ms eval "
+         << milliseconds(stats.evalTime) << "ms qsearch " << milliseconds(stats.qsearchTime) << "ms";
+    lines.push_back(line.str());
+    return lines;
+}
+
+std::string statsToJson(const SearchStats& stats) {
+    std::ostringstream out;
+    out << "{\"nodes\":" << stats.nodes
+        << ",\"qnodes\":" << stats.qnodes
+        << ",\"ttProbes\":" << stats.ttProbes
+        << ",\"ttHits\":" << stats.ttHits
+        << ",\"ttCutoffs\":" << stats.ttCutoffs
+        << ",\"failHighs\":" << stats.failHighs
+        << ",\"failHighsFirst\":" << stats.failHighsFirst
+        << ",\"movegenNs\":" << stats.movegenTime
+        << ",\"evalNs\":" << stats.evalTime
+        << ",\"qsearchNs\":" << stats.qsearchTime
+        << ",\"iterationNodes\":[";
+    // Both lists start at depth 1, which has no branching factor
+    for (int depth = 1; depth <= stats.iterations && depth < SearchStats::MaxDepth; ++depth) {
+        out << (depth > 1 ? "," : "") << stats.iterationNodes[depth];
+    }
+    out << "],\"ebf\":[" << std::fixed << std::setprecision(2);
+    for (int depth = 1; depth <= stats.iterations && depth < SearchStats::MaxDepth; ++depth) {
+        out << (depth > 1 ? "," : "") << stats.branchingFactor(depth);
+    }
+    out << "]}";
+    return out.str();
+}
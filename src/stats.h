@@ -0,0 +1,85 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Search statistics for tuning, compiled in only with CHESS_STATS_ENABLED (cmake -DCHESS_STATS=ON).
+// Each search thread counts into its own thread_local SearchStats, so counting needs no
+// synchronisation; the engine merges the threads' counters once the search is over. Without
+// the option every CHESS_STAT_* statement expands to nothing.
+struct SearchStats {
+    // Iterations deeper than this are not recorded; matches MaxPly
+    static constexpr int MaxDepth = 128;
+
+    // Main search nodes, the root included, and quiescence nodes
+    uint64_t nodes = 0;
+    uint64_t qnodes = 0;
+    uint64_t ttProbes = 0;
+    uint64_t ttHits = 0;
+    // Probes whose stored bound ended the node
+    uint64_t ttCutoffs = 0;
+    // Beta cutoffs in the main search, and how many of them came from the first move searched
+    uint64_t failHighs = 0;
+    uint64_t failHighsFirst = 0;
+    // Nanoseconds spent generating moves, evaluating and in quiescence search (evaluation included)
+    uint64_t movegenTime = 0;
+    uint64_t evalTime = 0;
+    uint64_t qsearchTime = 0;
+    // Nodes and qnodes of each completed iteration, by depth. Not summed by merge: helper threads
+    // skip depths, so the branching factor is read from the main thread's iterations alone.
+    uint64_t iterationNodes[MaxDepth] = {};
+    int iterations = 0;
+
+    void clear() { *this = SearchStats(); }
+    void merge(const SearchStats& other);
+    void recordIteration(int depth, uint64_t searched) {
+        if (depth >= MaxDepth) return;
+        iterationNodes[depth] = searched;
+        iterations = depth;
+    }
+    // Nodes of an iteration divided by those of the one before; 0 where unknown
+    double branchingFactor(int depth) const;
+};
+
+#ifdef CHESS_STATS_ENABLED
+constexpr bool StatsEnabled = true;
+
+// The counters of the search running on this thread
+extern thread_local SearchStats threadStats;
+
+// Adds the lifetime of the timer to one of the time counters
+class StatsTimer {
+public:
+    explicit StatsTimer(uint64_t& counter) : counter(counter), start(std::chrono::steady_clock::now()) {}
+    ~StatsTimer() {
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        counter += std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+    }
+    StatsTimer(const StatsTimer&) = delete;
+    StatsTimer& operator=(const StatsTimer&) = delete;
+
+private:
+    uint64_t& counter;
+    std::chrono::steady_clock::time_point start;
+};
+
+#define CHESS_STAT_INC(counter) (++threadStats.counter)
+#define CHESS_STAT_ITERATION(depth, searched) threadStats.recordIteration(depth, searched)
+// Times the rest of the enclosing scope; one per scope
+#define CHESS_STAT_TIMER(counter) StatsTimer chessStatsTimer(threadStats.counter)
+#else
+constexpr bool StatsEnabled = false;
+#define CHESS_STAT_INC(counter) ((void)0)
+#define CHESS_STAT_ITERATION(depth, searched) ((void)0)
+#define CHESS_STAT_TIMER(counter) ((void)0)
+#endif
+
+// Human-readable summary, one topic per line, for UCI info strings
+std::vector<std::string> formatStats(const SearchStats& stats);
+// The same figures as one JSON object, times in nanoseconds
+std::string statsToJson(const SearchStats& stats);
+
+#endif // STATS_H
@@ -0,0 +1,122 @@
+#include "tt.h"
+#include <algorithm>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace {
+
+// Data word layout: move 0-15, score 16-31, depth 32-39, bound 40-41, generation 42-47
+constexpr int GenerationBits = 6;
+constexpr uint8_t GenerationMask = (1 << GenerationBits) - 1;
+
+uint64_t pack(Move move, int score, int depth, Bound bound, uint8_t generation) {
+    return uint64_t(move.raw())
+         | uint64_t(uint16_t(int16_t(score))) << 16
+         | uint64_t(uint8_t(depth)) << 32
+         | uint64_t(static_cast<uint8_t>(bound)) << 40
+         | uint64_t(generation & GenerationMask) << 42;
+}
+
+Move moveOf(uint64_t data) { return Move::fromRaw(uint16_t(data)); }
+int scoreOf(uint64_t data) { return int16_t(uint16_t(data >> 16)); }
+int depthOf(uint64_t data) { return uint8_t(data >> 32); }
+Bound boundOf(uint64_t data) { return static_cast<Bound>((data >> 40) & 3); }
+uint8_t generationOf(uint64_t data) { return (data >> 42) & GenerationMask; }
+
+} // namespace
+
+TranspositionTable::TranspositionTable() : bucketCount(0), generation(0) {
+    resize(16);
+}
+
+void TranspositionTable::resize(size_t megabytes) {
+    size_t count = std::max<size_t>(1, megabytes * 1024 * 1024 / sizeof(Bucket));
+    buckets.reset(new Bucket[count]);
+    bucketCount = count;
+    clear();
+}
+
+void TranspositionTable::clear() {
+    for (size_t i = 0; i < bucketCount; ++i) {
+        for (Slot& slot : buckets[i].slots) {
+            slot.keyXorData.store(0, std::memory_order_relaxed);
+            slot.data.store(0, std::memory_order_relaxed);
+        }
+    }
+    generation = 0;
+}
+
+void TranspositionTable::newSearch() {
+    generation = (generation + 1) & GenerationMask;
+}
+
+// Maps the key onto [0, bucketCount) with a multiply instead of a modulo
+TranspositionTable::Bucket& TranspositionTable::bucketFor(uint64_t key) const {
+#if defined(_MSC_VER)
+    return buckets[__umulh(key, bucketCount)];
+#else
+    return buckets[(static_cast<unsigned __int128>(key) * bucketCount) >> 64];
+#endif
+}
+
+bool TranspositionTable::probe(uint64_t key, TTEntry& entry) const {
+    Bucket& bucket = bucketFor(key);
+    for (Slot& slot : bucket.slots) {
+        uint64_t data = slot.data.load(std::memory_order_relaxed);
+        uint64_t keyXorData = slot.keyXorData.load(std::memory_order_relaxed);
+        if ((keyXorData ^ data) == key && boundOf(data) != Bound::None) {
+            entry.move = moveOf(data);
+            entry.score = scoreOf(data);
+            entry.depth = depthOf(data);
+            entry.bound = boundOf(data);
+            return true;
+        }
+    }
+    return false;
+}
+
+void TranspositionTable::store(uint64_t key, Move move, int score, int depth, Bound bound) {
+    Bucket& bucket = bucketFor(key);
+    Slot* replace = nullptr;
+    int worstValue = 0;
+
+    for (Slot& slot : bucket.slots) {
+        uint64_t data = slot.data.load(std::memory_order_relaxed);
+        uint64_t keyXorData = slot.keyXorData.load(std::memory_order_relaxed);
+
+        if ((keyXorData ^ data) == key) {
+            // Same position: keep a deeper result from this search unless the new one is exact
+            if (bound != Bound::Exact && depth + 4 <= depthOf(data) && generationOf(data) == generation) {
+                return;
+            }
+            if (move.isNone()) move = moveOf(data);
+            replace = &slot;
+            break;
+        }
+
+        // Otherwise evict the shallowest entry, counting stale entries as much shallower
+        int age = (generation - generationOf(data)) & GenerationMask;
+        int value = boundOf(data) == Bound::None ? -1000 : depthOf(data) - 8 * age;
+        if (!replace || value < worstValue) {
+            replace = &slot;
+            worstValue = value;
+        }
+    }
+
+    uint64_t data = pack(move, score, depth, bound, generation);
+    replace->data.store(data, std::memory_order_relaxed);
+    replace->keyXorData.store(key ^ data, std::memory_order_relaxed);
+}
+
+int TranspositionTable::hashfull() const {
+    size_t sample = std::min<size_t>(bucketCount, 1000 / BucketSize);
+    int used = 0;
+    for (size_t i = 0; i < sample; ++i) {
+        for (const Slot& slot : buckets[i].slots) {
+            uint64_t data = slot.data.load(std::memory_order_relaxed);
+            if (boundOf(data) != Bound::None && generationOf(data) == generation) used++;
+        }
+    }
+    return static_cast<int>(used * 1000 / (sample * BucketSize));
+}
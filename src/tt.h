@@ -0,0 +1,59 @@
+#ifndef TT_H
+#define TT_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include "move.h"
+
+enum class Bound : uint8_t
+{
+    None,
+    Upper,
+    Lower,
+    Exact
+};
+
+struct TTEntry {
+    Move move;
+    int score;
+    int depth;
+    Bound bound;
+};
+
+// Fixed-size hash table of search results keyed by Zobrist key.
+// Each slot stores its data word next to (key ^ data), so a probe that races with a store on
+// another thread simply fails the key check instead of returning a torn entry. No locks are taken.
+class TranspositionTable {
+public:
+    TranspositionTable();
+    void resize(size_t megabytes);
+    void clear();
+    // Called once per search so entries from earlier searches are replaced first
+    void newSearch();
+
+    bool probe(uint64_t key, TTEntry& entry) const;
+    void store(uint64_t key, Move move, int score, int depth, Bound bound);
+    // Permille of sampled slots written during the current search, as reported by UCI
+    int hashfull() const;
+
+private:
+    struct Slot {
+        std::atomic<uint64_t> keyXorData;
+        std::atomic<uint64_t> data;
+    };
+    static constexpr int BucketSize = 4;
+    // One bucket per cache line so a probe touches a single line
+    struct alignas(64) Bucket {
+        Slot slots[BucketSize];
+    };
+
+    std::unique_ptr<Bucket[]> buckets;
+    size_t bucketCount;
+    uint8_t generation;
+
+    Bucket& bucketFor(uint64_t key) const;
+};
+
+#endif // TT_H
@@ -0,0 +1,70 @@
+#ifndef TYPES_H
+#define TYPES_H
+
+#include <cstdint>
+
+typedef uint64_t Bitboard;
+
+enum class PieceType
+{
+    King,
+    Queen,
+    Bishop,
+    Knight,
+    Rook,
+    Pawn,
+    None
+};
+
+enum class PieceColour
+{
+    White,
+    Black,
+    None
+};
+
+// Castling rights bitmask
+constexpr int WhiteKingside = 1;
+constexpr int WhiteQueenside = 2;
+constexpr int BlackKingside = 4;
+constexpr int BlackQueenside = 8;
+constexpr int AllCastling = 15;
+
+// Squares are numbered 0-63 starting at a1 and running along each rank (a1, b1, ..., h8).
+constexpr int NoSquare = 64;
+
+inline int makeSquare(int file, int rank) {
+    return rank * 8 + file;
+}
+
+inline int fileOf(int square) {
+    return square & 7;
+}
+
+inline int rankOf(int square) {
+    return square >> 3;
+}
+
+inline PieceColour opposite(PieceColour colour) {
+    return colour == PieceColour::White ? PieceColour::Black : PieceColour::White;
+}
+
+// One-byte piece code for the mailbox: the colour in bit 3 and the type in bits 0-2.
+// An empty square has type None, so typeOf needs no special case.
+typedef uint8_t Piece;
+
+constexpr Piece NoPiece = static_cast<Piece>(PieceType::None);
+
+inline Piece makePiece(PieceType type, PieceColour colour) {
+    return static_cast<Piece>(static_cast<int>(colour) << 3 | static_cast<int>(type));
+}
+
+inline PieceType typeOf(Piece piece) {
+    return static_cast<PieceType>(piece & 7);
+}
+
+inline PieceColour colourOf(Piece piece) {
+    return piece == NoPiece ? PieceColour::None : static_cast<PieceColour>(piece >> 3);
+}
+
+#endif // TYPES_H
@@ -0,0 +1,315 @@
+#include "uci.h"
+#include "log.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <iostream>
+
+namespace {
+
+const std::string StartFen = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+constexpr int DefaultHash = 16;
+constexpr int MaxHash = 65536;
+// Must match the engine's own default
+constexpr int DefaultMoveOverhead = 10;
+constexpr int MaxMoveOverhead = 5000;
+
+// The SearchParams switches and values, exposed as options for tuning and testing
+struct CheckParam {
+    const char* name;
+    bool SearchParams::*member;
+};
+
+struct SpinParam {
+    const char* name;
+    int SearchParams::*member;
+    int min;
+    int max;
+};
+
+const CheckParam CheckParams[] = {
+    { "NullMove", &SearchParams::nullMove },
+    { "LateMoveReductions", &SearchParams::lateMoveReductions },
+    { "ReverseFutility", &SearchParams::reverseFutility },
+    { "Futility", &SearchParams::futility },
+    { "CheckExtensions", &SearchParams::checkExtensions },
+};
+
+const SpinParam SpinParams[] = {
+    { "NullMoveMinDepth", &SearchParams::nullMoveMinDepth, 1, 64 },
+    { "NullMoveReduction", &SearchParams::nullMoveReduction, 1, 16 },
+    { "NullMoveDepthDivisor", &SearchParams::nullMoveDepthDivisor, 1, 64 },
+    { "NullMoveVerifyDepth", &SearchParams::nullMoveVerifyDepth, 1, MaxPly },
+    { "LmrMinDepth", &SearchParams::lmrMinDepth, 1, 64 },
+    { "LmrMinMoves", &SearchParams::lmrMinMoves, 1, 64 },
+    { "LmrBase", &SearchParams::lmrBase, 0, 500 },
+    { "LmrDivisor", &SearchParams::lmrDivisor, 1, 1000 },
+    { "LmrHistoryDivisor", &SearchParams::lmrHistoryDivisor, 1, 65536 },
+    { "ReverseFutilityMaxDepth", &SearchParams::reverseFutilityMaxDepth, 0, 64 },
+    { "ReverseFutilityMargin", &SearchParams::reverseFutilityMargin, 0, 1000 },
+    { "FutilityMaxDepth", &SearchParams::futilityMaxDepth, 0, 64 },
+    { "FutilityMarginBase", &SearchParams::futilityMarginBase, 0, 1000 },
+    { "FutilityMarginPerDepth", &SearchParams::futilityMarginPerDepth, 0, 1000 },
+};
+
+// Option names are case insensitive
+std::string toLower(std::string text) {
+    std::transform(text.begin(), text.end(), text.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return text;
+}
+
+int clampValue(const std::string& value, int min, int max) {
+    return std::max(min, std::min(max, std::atoi(value.c_str())));
+}
+
+std::string formatScore(int score) {
+    if (std::abs(score) < MateBound) return "cp " + std::to_string(score);
+    return "mate " + std::to_string(mateInMoves(score));
+}
+
+} // namespace
+
+Uci::Uci() {
+    engine.setHashSize(DefaultHash);
+    engine.setBoardState(StartFen);
+    engine.setInfoCallback([this](const SearchInfo& info) { sendInfo(info); });
+}
+
+Uci::~Uci() {
+    finishSearch();
+}
+
+void Uci::loop(std::istream& input) {
+    std::string line;
+    while (std::getline(input, line)) {
+        std::istringstream args(line);
+        std::string command;
+        args >> command;
+
+        if (command == "uci") {
+            handleUci();
+        } else if (command == "isready") {
+            send("readyok");
+        } else if (command == "ucinewgame") {
+            finishSearch();
+            engine.clearHash();
+        } else if (command == "position") {
+            finishSearch();
+            handlePosition(args);
+        } else if (command == "go") {
+            finishSearch();
+            handleGo(args);
+        } else if (command == "stop") {
+            finishSearch();
+        } else if (command == "ponderhit") {
+            engine.ponderhit();
+        } else if (command == "setoption") {
+            finishSearch();
+            handleSetOption(args);
+        } else if (command == "trace") {
+            finishSearch();
+            handleTrace(args);
+        } else if (command == "quit") {
+            break;
+        } else if (!command.empty()) {
+            send("info string unknown command " + command);
+        }
+    }
+    finishSearch();
+}
+
+void Uci::send(const std::string& line) {
+    std::lock_guard<std::mutex> lock(outputMutex);
+    std::cout << line << std::endl;
+}
+
+void Uci::finishSearch() {
+    if (!searchThread.joinable()) return;
+    engine.stop();
+    searchThread.join();
+}
+
+void Uci::handleUci() {
+    std::ostringstream out;
+    out << "id name chess_engine\n"
+        << "id author eparly\n"
+        << "option name Hash type spin default " << DefaultHash << " min 1 max " << MaxHash << "\n"
+        << "option name Threads type spin default 1 min 1 max " << MaxThreads << "\n"
+        << "option name Clear Hash type button\n"
+        << "option name Ponder type check default false\n"
+        << "option name UseNNUE type check default false\n"
+        << "option name EvalFile type string default <empty>\n"
+        << "option name Move Overhead type spin default " << DefaultMoveOverhead
+        << " min 0 max " << MaxMoveOverhead << "\n";
+
+    const SearchParams defaults;
+    for (const CheckParam& param : CheckParams) {
+        out << "option name " << param.name << " type check default "
+            << (defaults.*param.member ? "true" : "false") << "\n";
+    }
+    for (const SpinParam& param : SpinParams) {
+        out << "option name " << param.name << " type spin default " << defaults.*param.member
+            << " min " << param.min << " max " << param.max << "\n";
+    }
+    out << "uciok";
+    send(out.str());
+}
+
+// position [startpos | fen <fen>] [moves <move> ...]
+void Uci::handlePosition(std::istringstream& args) {
+    std::string token;
+    args >> token;
+
+    std::string fen;
+    if (token == "startpos") {
+        fen = StartFen;
+        args >> token;
+    } else if (token == "fen") {
+        while (args >> token && token != "moves") fen += (fen.empty() ? "" : " ") + token;
+    } else {
+        send("info string expected startpos or fen");
+        return;
+    }
+    FenError error;
+    if (!engine.setBoardState(fen, &error)) {
+        send(std::string("info string invalid fen: ") + error.message);
+        return;
+    }
+
+    if (token != "moves") return;
+    while (args >> token) {
+        if (!engine.applyMove(token)) {
+            send("info string illegal move " + token);
+            return;
+        }
+    }
+}
+
+void Uci::handleGo(std::istringstream& args) {
+    SearchLimits limits;
+    std::string token;
+    bool readingMoves = false;
+    while (args >> token) {
+        if (token == "searchmoves") {
+            readingMoves = true;
+            continue;
+        }
+        if (token == "infinite") {
+            limits.infinite = true;
+        } else if (token == "ponder") {
+            limits.ponder = true;
+        } else if (token == "depth") {
+            args >> limits.depth;
+        } else if (token == "nodes") {
+            args >> limits.nodes;
+        } else if (token == "movetime") {
+            args >> limits.movetime;
+        } else if (token == "wtime") {
+            args >> limits.wtime;
+        } else if (token == "btime") {
+            args >> limits.btime;
+        } else if (token == "winc") {
+            args >> limits.winc;
+        } else if (token == "binc") {
+            args >> limits.binc;
+        } else if (token == "movestogo") {
+            args >> limits.movestogo;
+        } else if (token == "mate") {
+            args >> limits.mate;
+        } else if (readingMoves) {
+            // searchmoves runs until the next keyword
+            Move move = engine.parseMove(token);
+            if (!move.isNone()) limits.searchMoves.push_back(move);
+            continue;
+        }
+        readingMoves = false;
+    }
+
+    // Prepared here rather than on the search thread, so a stop right after go is not lost
+    engine.prepareSearch(limits);
+    searchThread = std::thread([this]() {
+        Move best = engine.search();
+        if (StatsEnabled) {
+            for (const std::string& statsLine : formatStats(engine.getStats())) send("info string stats " + statsLine);
+        }
+        std::string line = "bestmove " + best.toString();
+        Move ponder = best.isNone() ? Move::none() : engine.getPonderMove(best);
+        if (!ponder.isNone()) line += " ponder " + ponder.toString();
+        send(line);
+    });
+}
+
+// setoption name <name> [value <value>]; both may contain spaces
+void Uci::handleSetOption(std::istringstream& args) {
+    std::string token, name, value;
+    args >> token;
+    if (token != "name") return;
+    while (args >> token && token != "value") name += (name.empty() ? "" : " ") + token;
+    while (args >> token) value += (value.empty() ? "" : " ") + token;
+
+    std::string key = toLower(name);
+    if (key == "hash") {
+        engine.setHashSize(clampValue(value, 1, MaxHash));
+    } else if (key == "threads") {
+        engine.setThreads(clampValue(value, 1, MaxThreads));
+    } else if (key == "clear hash") {
+        engine.clearHash();
+    } else if (key == "ponder") {
+        // Nothing to set up: pondering is requested per search with go ponder
+    } else if (key == "usennue") {
+        engine.setUseNnue(toLower(value) == "true");
+        if (toLower(value) == "true" && !engine.isUsingNnue()) {
+            send("info string no network loaded, set EvalFile first");
+        }
+    } else if (key == "evalfile") {
+        if (!engine.setEvalFile(value)) send("info string could not load network " + value);
+    } else if (key == "move overhead") {
+        engine.setMoveOverhead(clampValue(value, 0, MaxMoveOverhead));
+    } else {
+        SearchParams params = engine.getSearchParams();
+        for (const CheckParam& param : CheckParams) {
+            if (key == toLower(param.name)) {
+                params.*param.member = toLower(value) == "true";
+                engine.setSearchParams(params);
+                return;
+            }
+        }
+        for (const SpinParam& param : SpinParams) {
+            if (key == toLower(param.name)) {
+                params.*param.member = clampValue(value, param.min, param.max);
+                engine.setSearchParams(params);
+                return;
+            }
+        }
+        send("info string unknown option " + name);
+    }
+}
+
+void Uci::handleTrace(std::istringstream& args) {
+    if (!TraceEnabled) {
+        send("info string trace is not compiled in, build with -DCHESS_TRACE=ON");
+        return;
+    }
+    std::string action;
+    args >> action;
+    if (action == "clear") {
+        clearTrace();
+        return;
+    }
+    std::ostringstream out;
+    dumpTrace(out);
+    std::istringstream lines(out.str());
+    std::string line;
+    while (std::getline(lines, line)) send("info string trace " + line);
+}
+
+void Uci::sendInfo(const SearchInfo& info) {
+    uint64_t nps = info.nodes * 1000 / static_cast<uint64_t>(std::max<int64_t>(1, info.time));
+    std::ostringstream out;
+    out << "info depth " << info.depth << " score " << formatScore(info.score) << " nodes " << info.nodes
+        << " nps " << nps << " hashfull " << info.hashfull << " time " << info.time << " pv";
+    for (Move move : info.pv) out << " " << move.toString();
+    send(out.str());
+}
@@ -0,0 +1,40 @@
+#ifndef UCI_H
+#define UCI_H
+
+#include <istream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include "engine.h"
+
+// Universal Chess Interface front end. Commands are read on the calling thread while a
+// search runs on its own thread, so stop, ponderhit and isready are answered at once.
+class Uci {
+public:
+    Uci();
+    ~Uci();
+
+    // Handles commands until quit or the end of input
+    void loop(std::istream& input);
+
+private:
+    Engine engine;
+    std::thread searchThread;
+    // Output comes from both the input thread and the search thread
+    std::mutex outputMutex;
+
+    void send(const std::string& line);
+    // Stops any running search and waits for its bestmove to be sent
+    void finishSearch();
+
+    void handleUci();
+    void handlePosition(std::istringstream& args);
+    void handleGo(std::istringstream& args);
+    void handleSetOption(std::istringstream& args);
+    // Not part of UCI: "trace" prints the search trace as info strings, "trace clear" empties it
+    void handleTrace(std::istringstream& args);
+    void sendInfo(const SearchInfo& info);
+};
+
+#endif // UCI_H
@@ -0,0 +1,86 @@
+// Headless engine speaking the UCI protocol on stdin/stdout, for chess GUIs and
+// match tools such as cutechess-cli.
+//
+//   chess_engine_uci                 UCI on stdin/stdout
+//   chess_engine_uci batch [--depth N] [--nodes N] [--movetime MS] [--workers N] [--hash MB] [file]
+//                                    analyse a FEN/EPD file (or stdin) and write JSON lines
+//   chess_engine_uci bench [depth]   search the bench positions and print the node count and speed
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include "batch.h"
+#include "bench.h"
+#include "uci.h"
+
+namespace {
+
+constexpr int DefaultBatchDepth = 10;
+
+int runBatchCommand(int argc, char* argv[]) {
+    BatchOptions options;
+    options.workers = std::max(1u, std::thread::hardware_concurrency());
+    std::string path;
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--depth" && hasValue) {
+            options.limits.depth = std::atoi(argv[++i]);
+        } else if (arg == "--nodes" && hasValue) {
+            options.limits.nodes = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--movetime" && hasValue) {
+            options.limits.movetime = std::atoi(argv[++i]);
+        } else if (arg == "--workers" && hasValue) {
+            options.workers = std::atoi(argv[++i]);
+        } else if (arg == "--hash" && hasValue) {
+            options.hashMegabytes = std::strtoul(argv[++i], nullptr, 10);
+        } else if (path.empty() && arg[0] != '-') {
+            path = arg;
+        } else {
+            std::cerr << "usage: chess_engine_uci batch [--depth N] [--nodes N] [--movetime MS] "
+                         "[--workers N] [--hash MB] [file]" << std::endl;
+            return 2;
+        }
+    }
+    if (!options.limits.depth && !options.limits.nodes && !options.limits.movetime) {
+        options.limits.depth = DefaultBatchDepth;
+    }
+
+    size_t failures;
+    if (path.empty() || path == "-") {
+        failures = runBatch(options, std::cin, std::cout);
+    } else {
+        std::ifstream file(path);
+        if (!file) {
+            std::cerr << "cannot open " << path << std::endl;
+            return 2;
+        }
+        failures = runBatch(options, file, std::cout);
+    }
+    return failures ? 1 : 0;
+}
+
+int runBenchCommand(int argc, char* argv[]) {
+    int depth = argc > 2 ? std::atoi(argv[2]) : DefaultBenchDepth;
+    if (depth < 1 || argc > 3) {
+        std::cerr << "usage: chess_engine_uci bench [depth]" << std::endl;
+        return 2;
+    }
+    BenchResult result = runBench(depth, std::cout);
+    std::cout << "nodes " << result.nodes << " time " << result.milliseconds << "ms nps " << result.nps << std::endl;
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc > 1 && std::string(argv[1]) == "batch") return runBatchCommand(argc, argv);
+    if (argc > 1 && std::string(argv[1]) == "bench") return runBenchCommand(argc, argv);
+
+    Uci uci;
+    uci.loop(std::cin);
+    return 0;
+}